@@ -6,9 +6,15 @@
 #include <queue>
 #include <algorithm>
 #include <numeric>
+#include <limits>
+#include <cmath>
 #include <ranges>
+#include <string_view>
+#include <bit>
+#include <span>
 
 #include "simplex.h"
+#include "ilp.h"
 
 #include <fmt/format.h>
 #include <fmt/ranges.h>
@@ -113,10 +119,68 @@ int shortest1(b_t const& bt)
 	return -1;
 }
 
-int pt1(auto const& in)
+// the same BFS with the state space laid out flat. At most 2^jolt_sz light patterns,
+// each queued once, so a distance byte per pattern and a fixed queue on the stack.
+//
+int shortest1_flat(b_t const& bt)
+{
+	constexpr size_t states = size_t(1) << jolt_sz;
+	std::array<uint8_t, states> dist;
+	std::array<uint16_t, states> q;
+	dist.fill(0xff);
+	dist[0] = 0;
+	q[0] = 0;
+	size_t hd = 0;
+	size_t tl = 1;
+	while(hd != tl)
+	{
+		auto s = q[hd++];
+		if(s == bt.tgt_)
+			return dist[s];
+		for(auto pr: bt.press_)
+		{
+			auto nx = s ^ pr;
+			if(dist[nx] == 0xff)
+			{
+				dist[nx] = dist[s] + 1;
+				q[tl++] = uint16_t(nx);
+			}
+		}
+	}
+	return -1;
+}
+
+// pressing a button twice undoes it, so the answer is the smallest set of buttons
+// whose XOR is the target. Sets are tried by size, each size walked in order with
+// Gosper's hack, and the first hit is the answer.
+//
+int shortest1_xor(b_t const& bt)
+{
+	auto nb = bt.press_.size();
+	if(bt.tgt_ == 0)
+		return 0;
+	for(size_t k = 1; k <= nb; ++k)
+	{
+		uint32_t set = (uint32_t(1) << k) - 1;
+		while(set < (uint32_t(1) << nb))
+		{
+			uint32_t x = 0;
+			for(auto b = set; b; b &= b - 1)
+				x ^= bt.press_[std::countr_zero(b)];
+			if(x == bt.tgt_)
+				return int(k);
+			auto lo = set & -set;
+			auto hi = set + lo;
+			set = hi | (((set ^ hi) >> 2) / lo);
+		}
+	}
+	return -1;
+}
+
+int pt1(auto const& in, auto&& shortest)
 {
 	timer t("p1");
-	return std::ranges::fold_left(in, 0, [](auto sm, auto& b){ return sm + shortest1(b);});
+	return std::ranges::fold_left(in, 0, [&](auto sm, auto& b){ return sm + shortest(b);});
 }
 
 
@@ -146,7 +210,6 @@ auto build_coeff(b_t const& bt)
 	return out;
 }
 
-static int n = 0;
 int shortest2(b_t const& bt)
 {
 	auto A = build_coeff(bt);
@@ -154,22 +217,521 @@ int shortest2(b_t const& bt)
 	objective_t c = objective_t(A[0].size(), 1);
 
 	auto [_, m] = solve_equal_min(A, b, c);
-	fmt::println("{} {} {}", n, m, _);
-	++n;
 	return m;
-} 
+}
+
+// branch and bound over the same LP, integral and so exact
+int shortest2_ilp(b_t const& bt)
+{
+	auto A = build_coeff(bt);
+	target_t b = target_t(bt.jolts_.begin(), bt.jolts_.begin() + A.size());
+	objective_t c = objective_t(A[0].size(), 1);
+
+	auto r = solve_ilp(A, b, c);
+	return r ? int(std::lround(r->min_)) : -1;
+}
+
+// exact pt2, integers throughout. Fraction free Gauss-Jordan elimination of the counters
+// against the buttons leaves each pivot button's presses fixed by the free buttons',
+//
+//   D x_p = e_r - sum a_rf x_f
+//
+// with D the determinant of the pivot buttons' columns, the same in every row. With the
+// pivot button pressed at least none and at most as often as its smallest counter
+// allows, every row bounds a sum over the free buttons,
+//
+//   e_r - D top_p <= sum a_rf x_f <= e_r
+//
+// The total presses are linear in the free ones,
+//
+//   D total = E + sum c_f x_f,    E = sum e_r,    c_f = D - sum a_rf
+//
+// and once there's a best total that's one more row, sum c_f x_f <= D (best - 1) - E.
+//
+// Which buttons are free is picked first, by dual simplex in the same integers, so that
+// with each free button at the right end of its range the pivots are in theirs. That's
+// the LP optimum, and from there the bounds below are as tight as the relaxation. Each
+// free button starts in [0, top], and before anything is enumerated every row narrows
+// the range of every free button in it until none move. The narrowest button is tried
+// from its LP end, the rest narrowed again after each try. With one button left its
+// range is exact, so the first press count from its LP end that divides out in every
+// row is the best for that branch.
+//
+struct exact_t
+{
+	size_t nf_ = 0;
+	size_t nr_ = 0;
+	// the pivot rows over the free buttons then the objective row, nf_ to a row, each
+	// with rlo_ <= sum <= rhi_. A pivot row's rhi_ is its e_r.
+	std::vector<int64_t> a_;
+	std::vector<int64_t> rlo_;
+	std::vector<int64_t> rhi_;
+	int64_t dd_ = 1;
+	int64_t ee_ = 0;
+	// whether each free button is tried from its top, where the LP optimum has it
+	std::vector<bool> down_;
+	// the free buttons' ranges at each depth of the search, nf_ to a depth
+	std::vector<int64_t> lo_;
+	std::vector<int64_t> hi_;
+	int64_t best_ = std::numeric_limits<int64_t>::max();
+	bool none_ = false;
+
+	static constexpr int64_t unbounded = std::numeric_limits<int64_t>::max() / 4;
+
+	static int64_t floor_div(int64_t n, int64_t d)
+	{
+		// most coefficients are 1 or -1, and dividing is slow
+		if(d == 1 || d == -1)
+			return n * d;
+		auto q = n / d;
+		return (n % d != 0 && (n < 0) != (d < 0)) ? q - 1 : q;
+	}
+	static int64_t ceil_div(int64_t n, int64_t d)
+	{
+		return -floor_div(-n, d);
+	}
+	// n / d for any n d divides, without dividing. With d = 2^t o, o odd, it's n shifted
+	// down t times o's inverse mod 2^64.
+	static auto exact_div(int64_t d)
+	{
+		auto t = std::countr_zero(uint64_t(d));
+		auto o = uint64_t(d) >> t;
+		// Newton's iteration, each step doubles the bits right from the 3 o has
+		auto inv = o;
+		for(int n = 0; n < 5; ++n)
+			inv *= 2 - o * inv;
+		return [t, inv](int64_t n){ return int64_t(uint64_t(n >> t) * inv);};
+	}
+	int64_t const* row(size_t r) const
+	{
+		return a_.data() + r * nf_;
+	}
+
+	explicit exact_t(b_t const& bt)
+	{
+		auto nb = bt.press_.size();
+		auto w = nb + 1;
+		// the smallest counter each button feeds, and which counters any button feeds
+		std::vector<int64_t> top(nb, 0);
+		uint32_t fed = 0;
+		for(size_t c = 0; c < nb; ++c)
+		{
+			int64_t t = std::numeric_limits<int64_t>::max();
+			for(auto b = bt.press_[c]; b; b &= b - 1)
+				t = std::min<int64_t>(t, bt.jolts_[std::countr_zero(b)]);
+			top[c] = bt.press_[c] ? t : 0;
+			fed |= bt.press_[c];
+		}
+
+		// the system, a row per counter fed, the buttons then e, w to a row. A counter no
+		// button feeds has to be done already.
+		std::vector<int64_t> m;
+		m.reserve(jolt_sz * w);
+		for(size_t r = 0; r < jolt_sz; ++r)
+		{
+			if(!((fed >> r) & 1))
+			{
+				none_ = none_ || bt.jolts_[r] != 0;
+				continue;
+			}
+			for(size_t c = 0; c < nb; ++c)
+				m.emplace_back((bt.press_[c] >> r) & 1);
+			m.emplace_back(bt.jolts_[r]);
+		}
+		auto rows = m.size() / w;
+		auto at = [&](size_t r, size_t c) -> int64_t& { return m[r * w + c];};
+		// clear column c from every other row with row pr, fraction free as Bareiss has
+		// it. Every pivot is dd_, the determinant of the pivot columns so far, and the
+		// division by the last one is exact. Kept positive by negating every row.
+		auto clear = [&](size_t pr, size_t c)
+			{
+				auto p = at(pr, c);
+				auto div = exact_div(dd_);
+				for(size_t r = 0; r < rows; ++r)
+				{
+					if(r == pr || (at(r, c) == 0 && p == dd_))
+						continue;
+					auto f = at(r, c);
+					for(size_t k = 0; k < w; ++k)
+						at(r, k) = at(r, k) * p - at(pr, k) * f;
+					if(dd_ != 1)
+						for(size_t k = 0; k < w; ++k)
+							at(r, k) = div(at(r, k));
+				}
+				dd_ = p;
+				if(dd_ < 0)
+				{
+					for(auto& v : m)
+						v = -v;
+					dd_ = -dd_;
+				}
+			};
+
+		std::vector<size_t> piv;
+		std::vector<size_t> free;
+		for(size_t c = 0; c < nb; ++c)
+		{
+			auto row = piv.size();
+			auto r = row;
+			while(r < rows && at(r, c) == 0)
+				++r;
+			if(r == rows)
+			{
+				free.emplace_back(c);
+				continue;
+			}
+			if(r != row)
+				std::swap_ranges(m.begin() + r * w, m.begin() + (r + 1) * w, m.begin() + row * w);
+			clear(row, c);
+			piv.emplace_back(c);
+		}
+		// a counter with no button left has to be done already
+		for(size_t r = piv.size(); r < rows; ++r)
+			none_ = none_ || at(r, nb) != 0;
+		nr_ = piv.size();
+
+		// dual simplex over the bounded buttons. Each free button sits at 0 or top by the
+		// sign of its cost; while a pivot's presses are out of [0, top] the free button
+		// that brings them back for the least cost per press swaps in for it.
+		std::vector<bool> up(nb, false);
+		std::vector<int64_t> cost(nb, 0);
+		// each button's presses at its end, 0 or top
+		std::vector<int64_t> at_end(nb, 0);
+		for(size_t its = 0; !none_; ++its)
+		{
+			bool first = its == 0;
+			bool bland = its > nb;
+			for(auto f : free)
+			{
+				cost[f] = dd_;
+				for(size_t r = 0; r < nr_; ++r)
+					cost[f] -= at(r, f);
+				if(first)
+				{
+					up[f] = cost[f] < 0;
+					at_end[f] = up[f] ? top[f] : 0;
+				}
+			}
+			// the pivot furthest out of range. Should that go on too long, the one with the
+			// lowest button instead, Bland's rule, which can't cycle.
+			size_t lr = nr_;
+			int64_t ls = 0;
+			int64_t lv = 0;
+			for(size_t r = 0; r < nr_; ++r)
+			{
+				auto s = at(r, nb);
+				for(auto f : free)
+					s -= at(r, f) * at_end[f];
+				auto over = s < 0 ? -s : s - dd_ * top[piv[r]];
+				if(over > 0 && (bland ? lr == nr_ || piv[r] < piv[lr] : over > lv))
+				{
+					lr = r;
+					ls = s;
+					lv = over;
+				}
+			}
+			if(lr == nr_)
+				break;
+			bool low = ls < 0;
+			size_t in = nb;
+			for(auto f : free)
+			{
+				auto v = at(lr, f);
+				if(v == 0 || ((v < 0) != (low != up[f])))
+					continue;
+				if(in == nb || std::abs(cost[f] * at(lr, in)) < std::abs(cost[in] * v))
+					in = f;
+			}
+			// nothing can bring it back, not even the relaxation has a solution
+			if(in == nb)
+			{
+				none_ = true;
+				break;
+			}
+			auto out = piv[lr];
+			up[out] = !low;
+			up[in] = false;
+			at_end[out] = low ? 0 : top[out];
+			std::erase(free, in);
+			free.insert(std::ranges::upper_bound(free, out), out);
+			piv[lr] = in;
+			clear(lr, in);
+		}
 
-int pt2(auto const& in)
+		nf_ = free.size();
+		a_.resize((nr_ + 1) * nf_, dd_);
+		for(size_t r = 0; r < nr_; ++r)
+		{
+			for(size_t f = 0; f < nf_; ++f)
+			{
+				a_[r * nf_ + f] = at(r, free[f]);
+				a_[nr_ * nf_ + f] -= at(r, free[f]);
+			}
+			rlo_.emplace_back(at(r, nb) - dd_ * top[piv[r]]);
+			rhi_.emplace_back(at(r, nb));
+			ee_ += at(r, nb);
+		}
+		rlo_.emplace_back(-unbounded);
+		rhi_.emplace_back(unbounded);
+
+		for(auto f : free)
+			down_.push_back(up[f]);
+		lo_.assign((nf_ + 1) * nf_, 0);
+		hi_.assign((nf_ + 1) * nf_, 0);
+		for(size_t f = 0; f < nf_; ++f)
+			hi_[f] = top[free[f]];
+	}
+	// narrow lo and hi by every row until nothing moves, false if a row can't be met
+	bool narrow(std::span<int64_t> lo, std::span<int64_t> hi) const
+	{
+		for(bool moved = true; moved; )
+		{
+			moved = false;
+			for(size_t r = 0; r <= nr_; ++r)
+			{
+				auto a = row(r);
+				int64_t mn = 0;
+				int64_t mx = 0;
+				for(size_t f = 0; f < nf_; ++f)
+				{
+					mn += a[f] > 0 ? a[f] * lo[f] : a[f] * hi[f];
+					mx += a[f] > 0 ? a[f] * hi[f] : a[f] * lo[f];
+				}
+				if(mn > rhi_[r] || mx < rlo_[r])
+					return false;
+				for(size_t f = 0; f < nf_; ++f)
+				{
+					if(a[f] == 0 || lo[f] == hi[f])
+						continue;
+					// what the others leave for this one, rlo - omx <= a x <= rhi - omn
+					auto omn = mn - (a[f] > 0 ? a[f] * lo[f] : a[f] * hi[f]);
+					auto omx = mx - (a[f] > 0 ? a[f] * hi[f] : a[f] * lo[f]);
+					auto l = a[f] > 0 ? ceil_div(rlo_[r] - omx, a[f]) : ceil_div(rhi_[r] - omn, a[f]);
+					auto h = a[f] > 0 ? floor_div(rhi_[r] - omn, a[f]) : floor_div(rlo_[r] - omx, a[f]);
+					if(l > lo[f])
+					{
+						lo[f] = l;
+						moved = true;
+					}
+					if(h < hi[f])
+					{
+						hi[f] = h;
+						moved = true;
+					}
+					if(lo[f] > hi[f])
+						return false;
+				}
+			}
+		}
+		return true;
+	}
+	// the total with the free presses x, or -1 if a pivot's presses don't divide out
+	int64_t total(std::span<int64_t const> x) const
+	{
+		int64_t t = ee_;
+		for(size_t f = 0; f < nf_; ++f)
+			t += row(nr_)[f] * x[f];
+		if(dd_ == 1)
+			return t;
+		for(size_t r = 0; r < nr_; ++r)
+		{
+			auto s = rhi_[r];
+			for(size_t f = 0; f < nf_; ++f)
+				s -= row(r)[f] * x[f];
+			if(s % dd_ != 0)
+				return -1;
+		}
+		return t / dd_;
+	}
+	void found(int64_t t)
+	{
+		if(t < best_)
+		{
+			best_ = t;
+			rhi_.back() = dd_ * (best_ - 1) - ee_;
+		}
+	}
+	void search(size_t k)
+	{
+		std::span<int64_t> lo(lo_.data() + k * nf_, nf_);
+		std::span<int64_t> hi(hi_.data() + k * nf_, nf_);
+		if(!narrow(lo, hi))
+			return;
+		// the narrowest button still open, and how many are
+		size_t nf = nf_;
+		size_t open = 0;
+		for(size_t f = 0; f < nf_; ++f)
+			if(lo[f] != hi[f])
+			{
+				++open;
+				if(nf == nf_ || hi[f] - lo[f] < hi[nf] - lo[nf])
+					nf = f;
+			}
+		if(open == 0)
+		{
+			if(auto t = total(lo); t >= 0)
+				found(t);
+			return;
+		}
+		if(open == 1)
+		{
+			auto from = down_[nf] ? hi[nf] : lo[nf];
+			auto to = down_[nf] ? lo[nf] : hi[nf];
+			auto dir = down_[nf] ? -1 : 1;
+			for(auto x = from; x != to + dir; x += dir)
+			{
+				lo[nf] = x;
+				if(auto t = total(lo); t >= 0)
+				{
+					found(t);
+					break;
+				}
+			}
+			return;
+		}
+		std::span<int64_t> clo(lo_.data() + (k + 1) * nf_, nf_);
+		std::span<int64_t> chi(hi_.data() + (k + 1) * nf_, nf_);
+		while(true)
+		{
+			auto x = down_[nf] ? hi[nf] : lo[nf];
+			std::ranges::copy(lo, clo.begin());
+			std::ranges::copy(hi, chi.begin());
+			clo[nf] = x;
+			chi[nf] = x;
+			search(k + 1);
+			if(lo[nf] == hi[nf])
+				return;
+			// the rest of the range, narrowed again now that there may be a better best
+			if(down_[nf])
+				--hi[nf];
+			else
+				++lo[nf];
+			if(!narrow(lo, hi))
+				return;
+		}
+	}
+	int64_t solve()
+	{
+		if(none_)
+			return -1;
+		// the LP optimum itself, when its presses divide out nothing beats it and the
+		// search stops at the root. The next depth's ranges are free to hold it.
+		std::span<int64_t> x(lo_.data() + nf_, nf_);
+		for(size_t f = 0; f < nf_; ++f)
+			x[f] = down_[f] ? hi_[f] : lo_[f];
+		if(auto t = total(x); t >= 0)
+			found(t);
+		search(0);
+		return best_ == std::numeric_limits<int64_t>::max() ? -1 : best_;
+	}
+};
+
+int shortest2_exact(b_t const& bt)
+{
+	return int(exact_t(bt).solve());
+}
+
+int pt2(auto const& in, auto&& shortest)
 {
 	timer t("p2");
-	return std::ranges::fold_left(in, 0, [](auto sm, auto& b){ return sm + shortest2(b);});
+	return std::ranges::fold_left(in, 0, [&](auto sm, auto& b){ return sm + shortest(b);});
+}
+
+// machines where the simplex or branch and bound disagree with the exact engine, or the
+// pt1 engines with the original BFS
+void verify(auto const& in)
+{
+	int bad = 0;
+	for(size_t n = 0; n < in.size(); ++n)
+	{
+		auto q = shortest1(in[n]);
+		auto f = shortest1_flat(in[n]);
+		auto s = shortest1_xor(in[n]);
+		if(f != q || s != q)
+		{
+			fmt::println("machine {} bfs {} flat {} xor {}", n, q, f, s);
+			++bad;
+		}
+		auto l = shortest2(in[n]);
+		auto i = shortest2_ilp(in[n]);
+		auto x = shortest2_exact(in[n]);
+		if(l != x || i != x)
+		{
+			fmt::println("machine {} simplex {} ilp {} exact {}", n, l, i, x);
+			++bad;
+		}
+	}
+	fmt::println("{} of {} machines differ", bad, in.size());
+}
+
+struct engine_t
+{
+	std::string_view name_;
+	int part_;
+	int (*shortest_)(b_t const&);
+};
+
+constexpr engine_t engines[] = {
+	{ "bfs",     1, shortest1 },
+	{ "flat",    1, shortest1_flat },
+	{ "xor",     1, shortest1_xor },
+	{ "simplex", 2, shortest2 },
+	{ "exact",   2, shortest2_exact },
+	{ "ilp",     2, shortest2_ilp },
+};
+
+// each part by every engine over the machine set, repeated for at least 200ms
+//
+void bench(auto const& in)
+{
+	fmt::println("{} machines", in.size());
+	for(auto const& e : engines)
+	{
+		auto[r, ns] = repeat_for(200ms, [&]{ return std::ranges::fold_left(in, 0, [&](auto sm, auto& b){ return sm + e.shortest_(b);});});
+		fmt::println("{:>7} : pt{} = {}, {:.3f} us/machine", e.name_, e.part_, r, ns / (1000.0 * in.size()));
+	}
 }
 
-int main()
+// pt1 is the subset XOR search, -q the original BFS, -f the flat BFS.
+// pt2 is the exact engine, -l the floating point simplex instead, -i branch and bound.
+// -v compare them, -B benchmark them
+//
+int main(int ac, char* av[])
 {
+	char p1e = 'x';
+	bool lp = false;
+	bool ilp = false;
+	bool check = false;
+	bool bn = false;
+	for(int n = 1; n < ac; ++n)
+	{
+		std::string_view a(av[n]);
+		if(a == "-q")
+			p1e = 'q';
+		else if(a == "-f")
+			p1e = 'f';
+		else if(a == "-l")
+			lp = true;
+		else if(a == "-i")
+			ilp = true;
+		else if(a == "-v")
+			check = true;
+		else if(a == "-B")
+			bn = true;
+	}
 	auto in = get_input();
-	auto p1 = pt1(in);
-	auto p2 = pt2(in);
+	if(check)
+	{
+		verify(in);
+		return 0;
+	}
+	if(bn)
+	{
+		bench(in);
+		return 0;
+	}
+	auto p1 = p1e == 'q' ? pt1(in, shortest1) : p1e == 'f' ? pt1(in, shortest1_flat) : pt1(in, shortest1_xor);
+	auto p2 = lp ? pt2(in, shortest2) : ilp ? pt2(in, shortest2_ilp) : pt2(in, shortest2_exact);
 	fmt::println("pt1 = {}", p1);
 	fmt::println("pt2 = {}", p2);
-}
\ No newline at end of file
+}
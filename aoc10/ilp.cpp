@@ -0,0 +1,307 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "ilp.h"
+
+namespace
+{
+const double EPS = 1e-9;
+const double INT_EPS = 1e-6; // how far from an integer still counts as one
+const double INF = std::numeric_limits<double>::infinity();
+
+// dense tableau, m_ constraint rows then the objective row, n_ columns then the right
+// hand side. The objective row holds the reduced costs and, in its rhs, minus the
+// objective value.
+//
+struct tableau_t
+{
+	size_t m_ = 0;
+	size_t n_ = 0;
+	std::vector<double> a_;
+	std::vector<size_t> basis_;
+
+	tableau_t() = default;
+	tableau_t(size_t m, size_t n) : m_{ m }, n_{ n }, a_((m + 1) * (n + 1), 0), basis_(m, 0)
+	{
+	}
+	double* row(size_t r)
+	{
+		return a_.data() + r * (n_ + 1);
+	}
+	double const* row(size_t r) const
+	{
+		return a_.data() + r * (n_ + 1);
+	}
+	double& at(size_t r, size_t c)
+	{
+		return a_[r * (n_ + 1) + c];
+	}
+	double at(size_t r, size_t c) const
+	{
+		return a_[r * (n_ + 1) + c];
+	}
+	double& rhs(size_t r)
+	{
+		return at(r, n_);
+	}
+	double rhs(size_t r) const
+	{
+		return at(r, n_);
+	}
+	double value() const
+	{
+		return -rhs(m_);
+	}
+	void pivot(size_t row, size_t col)
+	{
+		auto pv = at(row, col);
+		for(size_t j = 0; j <= n_; ++j)
+			at(row, j) /= pv;
+		for(size_t i = 0; i <= m_; ++i)
+		{
+			auto f = at(i, col);
+			if(i == row || std::abs(f) < EPS)
+				continue;
+			for(size_t j = 0; j <= n_; ++j)
+				at(i, j) -= f * at(row, j);
+			at(i, col) = 0;
+		}
+		basis_[row] = col;
+	}
+	// primal simplex over the first cols columns, Bland's rule so degenerate pivots
+	// can't cycle. false if unbounded
+	bool primal(size_t cols)
+	{
+		while(true)
+		{
+			size_t e = cols;
+			for(size_t j = 0; j < cols && e == cols; ++j)
+				if(at(m_, j) < -EPS)
+					e = j;
+			if(e == cols)
+				return true;
+			size_t l = m_;
+			double best = INF;
+			for(size_t i = 0; i < m_; ++i)
+			{
+				if(at(i, e) <= EPS)
+					continue;
+				auto r = rhs(i) / at(i, e);
+				if(r < best - EPS || (r < best + EPS && basis_[i] < basis_[l]))
+				{
+					best = r;
+					l = i;
+				}
+			}
+			if(l == m_)
+				return false;
+			pivot(l, e);
+		}
+	}
+	// dual simplex, reduced costs all >= 0 on entry and kept so. false if infeasible
+	bool dual()
+	{
+		while(true)
+		{
+			size_t l = m_;
+			double mn = -EPS;
+			for(size_t i = 0; i < m_; ++i)
+				if(rhs(i) < mn)
+				{
+					mn = rhs(i);
+					l = i;
+				}
+			if(l == m_)
+				return true;
+			size_t e = n_;
+			double best = INF;
+			for(size_t j = 0; j < n_; ++j)
+				if(at(l, j) < -EPS)
+				{
+					auto r = at(m_, j) / -at(l, j);
+					if(r < best)
+					{
+						best = r;
+						e = j;
+					}
+				}
+			if(e == n_)
+				return false;
+			pivot(l, e);
+		}
+	}
+	// a copy with one more row, coef.x + s = r, and the new slack s basic in it
+	tableau_t with_row(std::vector<double> const& coef, double r) const
+	{
+		tableau_t t(m_ + 1, n_ + 1);
+		for(size_t i = 0; i < m_; ++i)
+		{
+			std::copy_n(row(i), n_, t.row(i));
+			t.rhs(i) = rhs(i);
+		}
+		std::copy_n(coef.data(), n_, t.row(m_));
+		t.at(m_, n_) = 1;
+		t.rhs(m_) = r;
+		std::copy_n(row(m_), n_, t.row(t.m_));
+		t.rhs(t.m_) = rhs(m_);
+		std::copy_n(basis_.begin(), m_, t.basis_.begin());
+		t.basis_[m_] = n_;
+		return t;
+	}
+};
+
+// phase one with an artificial per row, then the artificials are driven out of the
+// basis, rows left with only artificials are redundant and dropped. nullopt if
+// infeasible or unbounded
+//
+std::optional<tableau_t> root(constraint_t const& A, target_t const& b, objective_t const& c)
+{
+	auto m = A.size();
+	auto n = c.size();
+	tableau_t p1(m, n + m);
+	for(size_t i = 0; i < m; ++i)
+	{
+		auto s = b[i] < 0 ? -1.0 : 1.0;
+		for(size_t j = 0; j < n; ++j)
+			p1.at(i, j) = s * A[i][j];
+		p1.at(i, n + i) = 1;
+		p1.rhs(i) = s * b[i];
+		p1.basis_[i] = n + i;
+		for(size_t j = 0; j < n; ++j)
+			p1.at(m, j) -= p1.at(i, j);
+		p1.rhs(m) -= p1.rhs(i);
+	}
+	p1.primal(n + m);
+	if(p1.value() > INT_EPS)
+		return std::nullopt;
+
+	std::vector<size_t> keep;
+	for(size_t i = 0; i < m; ++i)
+	{
+		if(p1.basis_[i] >= n)
+		{
+			size_t j = 0;
+			while(j < n && std::abs(p1.at(i, j)) < EPS)
+				++j;
+			if(j == n)
+				continue;
+			p1.pivot(i, j);
+		}
+		keep.push_back(i);
+	}
+
+	tableau_t t(keep.size(), n);
+	for(size_t i = 0; i < keep.size(); ++i)
+	{
+		std::copy_n(p1.row(keep[i]), n, t.row(i));
+		t.rhs(i) = p1.rhs(keep[i]);
+		t.basis_[i] = p1.basis_[keep[i]];
+	}
+	std::copy_n(c.begin(), n, t.row(t.m_));
+	for(size_t i = 0; i < t.m_; ++i)
+	{
+		auto f = c[t.basis_[i]];
+		for(size_t j = 0; j <= n; ++j)
+			t.at(t.m_, j) -= f * t.at(i, j);
+	}
+	if(!t.primal(n))
+		return std::nullopt;
+	return t;
+}
+
+struct node_t
+{
+	double bound_;
+	tableau_t t_;
+};
+}
+
+std::optional<ilp_t> solve_ilp(constraint_t const& constraints,
+								target_t const& b,
+								objective_t const& c)
+{
+	auto n = c.size();
+	auto t = root(constraints, b, c);
+	if(!t)
+		return std::nullopt;
+
+	bool int_obj = std::ranges::all_of(c, [](auto v){ return v == std::round(v);});
+	auto bound = [&](tableau_t const& t){ return int_obj ? std::ceil(t.value() - INT_EPS) : t.value();};
+
+	// a min heap on the bound
+	auto cmp = [](node_t const& l, node_t const& r){ return l.bound_ > r.bound_;};
+	std::vector<node_t> open;
+	open.push_back({ bound(*t), std::move(*t) });
+
+	ilp_t r{ {}, INF, 0 };
+	std::vector<double> coef;
+	while(!open.empty())
+	{
+		// best first, so once the best open bound can't beat the incumbent nothing can
+		if(open.front().bound_ >= r.min_ - INT_EPS)
+			break;
+		std::ranges::pop_heap(open, cmp);
+		auto nd = std::move(open.back());
+		open.pop_back();
+		++r.nodes_;
+		auto const& tb = nd.t_;
+
+		// branch on the most fractional of the original variables
+		size_t row = tb.m_;
+		double fr = INT_EPS;
+		for(size_t i = 0; i < tb.m_; ++i)
+		{
+			if(tb.basis_[i] >= n)
+				continue;
+			auto v = tb.rhs(i);
+			auto d = std::min(v - std::floor(v), std::ceil(v) - v);
+			if(d > fr)
+			{
+				fr = d;
+				row = i;
+			}
+		}
+		if(row == tb.m_)
+		{
+			if(tb.value() < r.min_)
+			{
+				r.min_ = tb.value();
+				r.x_.assign(n, 0);
+				for(size_t i = 0; i < tb.m_; ++i)
+					if(tb.basis_[i] < n)
+						r.x_[tb.basis_[i]] = std::round(tb.rhs(i));
+			}
+			continue;
+		}
+
+		// the basic variable's row is x_j + sum a_k x_k = v. With the new slack s,
+		//
+		//   x_j <= floor(v)   is   - sum a_k x_k + s = floor(v) - v
+		//   x_j >= ceil(v)    is     sum a_k x_k + s = v - ceil(v)
+		//
+		// both infeasible in the parent's basis but dual feasible.
+		auto v = tb.rhs(row);
+		auto j = tb.basis_[row];
+		coef.assign(tb.row(row), tb.row(row) + tb.n_);
+		coef[j] = 0;
+		for(int up = 0; up < 2; ++up)
+		{
+			// negated for the down branch, back again for the up
+			for(auto& a : coef)
+				a = -a;
+			auto ch = tb.with_row(coef, up ? v - std::ceil(v) : std::floor(v) - v);
+			if(!ch.dual())
+				continue;
+			auto bd = bound(ch);
+			if(bd < r.min_ - INT_EPS)
+			{
+				open.push_back({ bd, std::move(ch) });
+				std::ranges::push_heap(open, cmp);
+			}
+		}
+	}
+	if(r.min_ == INF)
+		return std::nullopt;
+	return r;
+}
@@ -0,0 +1,27 @@
+// branch and bound integer linear programming over the simplex types.
+//
+
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+#include "simplex.h"
+
+// minimise c.x subject to A x = b, x >= 0 and integer. Each node keeps its optimal
+// tableau, a child adds its branching bound as one new row and is re-solved from the
+// parent's basis by dual simplex. Open nodes are taken best bound first. When c is
+// integral so is the objective, and the LP bound is rounded up before pruning.
+//
+struct ilp_t
+{
+	std::vector<double> x_;
+	double min_;
+	int64_t nodes_;
+};
+
+// nullopt if infeasible or unbounded
+std::optional<ilp_t> solve_ilp(constraint_t const& constraints,
+								target_t const& b,
+								objective_t const& c);
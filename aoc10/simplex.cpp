@@ -3,6 +3,15 @@
 //
 #include <limits>
 #include <stdexcept>
+#include <array>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #include "simplex.h"
 
@@ -27,28 +36,105 @@ const double EPS = 1e-9; // Tolerance for floating-point comparisons
 
 using T = double;
 
-std::pair<std::vector<T>, T> solve_equal_min (constraint_t const& constraints,
-                                                            target_t const& b,
-                                                            objective_t const& c)
+namespace
+{
+// row kernels over whole padded rows, w a multiple of 4 and both rows 32 byte aligned.
+// Multiply then subtract, not fused, so the AVX2 path gives the scalar path's results.
+//
+void row_div(T* r, T d, size_t w)
+{
+#if defined(__AVX2__)
+    auto vd = _mm256_set1_pd(d);
+    for (size_t j = 0; j < w; j += 4)
+        _mm256_store_pd(r + j, _mm256_div_pd(_mm256_load_pd(r + j), vd));
+#else
+    for (size_t j = 0; j < w; j++)
+        r[j] /= d;
+#endif
+}
+
+void row_sub(T* __restrict r, T const* __restrict p, T f, size_t w)
+{
+#if defined(__AVX2__)
+    auto vf = _mm256_set1_pd(f);
+    for (size_t j = 0; j < w; j += 4)
+        _mm256_store_pd(r + j, _mm256_sub_pd(_mm256_load_pd(r + j), _mm256_mul_pd(vf, _mm256_load_pd(p + j))));
+#else
+    for (size_t j = 0; j < w; j++)
+        r[j] -= f * p[j];
+#endif
+}
+
+struct aligned_delete
+{
+    void operator()(T* p) const
+    {
+        ::operator delete[](p, std::align_val_t{ 32 });
+    }
+};
+
+// the tableau in one contiguous buffer, rows padded to a multiple of 4 doubles. R x C
+// is a capacity fixed at compile time, held inline; 0 x 0 allocates once per problem.
+// Either way nothing allocates once the simplex is running.
+//
+template<size_t R, size_t C> class tableau
+{
+    static constexpr bool fixed = R != 0;
+    static_assert(C % 4 == 0);
+    using store_t = std::conditional_t<fixed, std::array<T, R * C>, std::unique_ptr<T[], aligned_delete>>;
+
+    alignas(32) store_t a_;
+    size_t w_;
+
+public:
+    tableau(size_t rows, size_t cols) : w_{ (cols + 3) & ~size_t(3) }
+    {
+        if constexpr (fixed)
+            std::fill_n(a_.begin(), rows * w_, 0.0);
+        else
+        {
+            a_.reset(static_cast<T*>(::operator new[](rows * w_ * sizeof(T), std::align_val_t{ 32 })));
+            std::fill_n(a_.get(), rows * w_, 0.0);
+        }
+    }
+    static bool fits(size_t rows, size_t cols)
+    {
+        return !fixed || (rows <= R && cols <= C);
+    }
+    T* operator[](size_t r)
+    {
+        if constexpr (fixed)
+            return a_.data() + r * w_;
+        else
+            return a_.get() + r * w_;
+    }
+    size_t width() const
+    {
+        return w_;
+    }
+};
+
+template<size_t R, size_t C> std::pair<std::vector<T>, T> solve(constraint_t const& constraints,
+                                                                target_t const& b,
+                                                                objective_t const& c)
 {
-    std::vector<std::vector<T>> A; // Tableau
-	std::vector<int> basis;        // Basic variable indices
     auto m = constraints.size();
     auto n = c.size();
+    auto rhs = n + m; // Columns: original vars + artificial vars + RHS
+    tableau<R, C> A(m + 1, rhs + 1);
+    auto w = A.width();
+    std::array<int, R == 0 ? 1 : R> fbasis;
+    std::vector<int> dbasis(R == 0 ? m : 0);
+    int* basis = R == 0 ? dbasis.data() : fbasis.data(); // Basic variable indices
 
     auto pivot = [&](int row, int col)
         {
-            double pivotVal = A[row][col];
-            for (auto& x : A[row])
-                x /= pivotVal;
+            row_div(A[row], A[row][col], w);
             for (int i = 0; i <= m; i++)
             {
-                if (i != row)
-                {
-                    auto factor = A[i][col];
-                    for (auto j = 0; j < A[i].size(); j++)
-                        A[i][j] -= factor * A[row][j];
-                }
+                auto factor = A[i][col];
+                if (i != row && factor != 0)
+                    row_sub(A[i], A[row], factor, w);
             }
         };
     auto simplex = [&](int cols)
@@ -72,7 +158,7 @@ std::pair<std::vector<T>, T> solve_equal_min (constraint_t const& constraints,
                 {
                     if (A[i][pivotCol] > EPS)
                     {
-                        double ratio = (double)A[i].back() / A[i][pivotCol];
+                        double ratio = A[i][rhs] / A[i][pivotCol];
                         if (ratio < minRatio)
                         {
                             minRatio = ratio;
@@ -88,71 +174,61 @@ std::pair<std::vector<T>, T> solve_equal_min (constraint_t const& constraints,
             }
         };
 
-    // Build initial tableau for Phase 1
-    // Columns: original vars + artificial vars + RHS
-    A.assign(m + 1, std::vector<T>(n + m + 1, 0.0));
-
-    // Fill constraint coefficients
-    for (int i = 0; i < m; i++) {
-        for (int j = 0; j < n; j++) {
-            A[i][j] = constraints[i][j];
-        }
-    }
-
-    // Add artificial variables for equality constraints
-    for (int i = 0; i < m; i++) {
-        A[i][n + i] = 1.0; // Artificial variable
-        basis.push_back(n + i);
-    }
-
-    // RHS
-    for (int i = 0; i < m; i++) {
-        A[i].back() = b[i];
+    // Fill constraint coefficients, an artificial variable per equality constraint
+    // and the RHS
+    for (int i = 0; i < m; i++)
+    {
+        std::copy_n(constraints[i].begin(), n, A[i]);
+        A[i][n + i] = 1.0;
+        basis[i] = n + i;
+        A[i][rhs] = b[i];
     }
 
-    // Phase 1 objective: minimize sum of artificial vars
-    for (int j = n; j < n + m; j++) {
+    // Phase 1 objective: minimize sum of artificial vars, made consistent
+    for (int j = n; j < n + m; j++)
         A[m][j] = 1.0;
-    }
-
-    // Make Phase 1 objective row consistent
-    for (int i = 0; i < m; i++) {
-        for (int j = 0; j <= n + m; j++) {
-            A[m][j] -= A[i][j];
-        }
-    }
+    for (int i = 0; i < m; i++)
+        row_sub(A[m], A[i], 1.0, w);
 
     // Run Phase 1
     simplex(n + m);
 
-//    if (A[m].back() > EPS) {
+//    if (A[m][rhs] > EPS) {
 //        throw std::runtime_error("No feasible solution (infeasible problem).");
 //    }
 
     // Remove artificial variables and set original objective
-    A[m].assign(n + m + 1, 0.0);
-    for (int j = 0; j < n; j++) {
-        A[m][j] = c[j]; // Original minimization objective
-    }
+    std::fill_n(A[m], w, 0.0);
+    std::copy_n(c.begin(), n, A[m]);
 
     // Adjust objective row for current basis
-    for (int i = 0; i < m; i++) {
-        if (basis[i] < n) {
-            for (int j = 0; j <= n + m; j++) {
-                A[m][j] -= A[i][j] * c[basis[i]];
-            }
-        }
-    }
+    for (int i = 0; i < m; i++)
+        if (basis[i] < n)
+            row_sub(A[m], A[i], c[basis[i]], w);
 
     // Run Phase 2
     simplex(n);
-    
+
     // extract solution
     std::vector<T> x(n, 0.0);
     for (int i = 0; i < m; i++)
         if (basis[i] < n)
-            x[basis[i]] = A[i].back();
-            
+            x[basis[i]] = A[i][rhs];
 
-    return { x, -1 * A[m].back() };
+    return { x, -1 * A[m][rhs] };
+}
+}
+
+// a day 10 machine is at most 10 counters, and rarely more than a dozen buttons, so
+// the fixed tableau covers every one. Anything bigger takes the allocating one.
+//
+std::pair<std::vector<T>, T> solve_equal_min (constraint_t const& constraints,
+                                                            target_t const& b,
+                                                            objective_t const& c)
+{
+    auto rows = constraints.size() + 1;
+    auto cols = c.size() + constraints.size() + 1;
+    if (tableau<16, 48>::fits(rows, cols))
+        return solve<16, 48>(constraints, b, c);
+    return solve<0, 0>(constraints, b, c);
 }
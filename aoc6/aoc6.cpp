@@ -4,18 +4,121 @@
 #include <algorithm>
 #include <numeric>
 #include <ranges>
+#include <string_view>
+#include <bit>
+#include <stdexcept>
+#include <thread>
+#include <future>
 
 #include <fmt/format.h>
 
 #include "ctre_inc.h"
 #include "timer.h"
 
-struct sum_t
+// operands are held in the arithmetic type too, a vertical number is a digit per row
+// so can outgrow int64_t on its own.
+template<typename T> struct sum_t
 {
-	std::vector<int64_t> vars_;
+	std::vector<T> vars_;
 	bool prod_ = false;
 };
-using sums = std::vector<sum_t>;
+template<typename T> using sums = std::vector<sum_t<T>>;
+
+// arithmetic that throws rather than wrapping. checked<int64_t> or checked<__int128>
+//
+template<typename T> struct checked
+{
+	T v_ = 0;
+	checked() = default;
+	checked(T v) : v_{ v }
+	{
+	}
+	friend checked operator+(checked a, checked b)
+	{
+		T r;
+		if(__builtin_add_overflow(a.v_, b.v_, &r))
+			throw std::overflow_error("sum overflow");
+		return r;
+	}
+	friend checked operator*(checked a, checked b)
+	{
+		T r;
+		if(__builtin_mul_overflow(a.v_, b.v_, &r))
+			throw std::overflow_error("product overflow");
+		return r;
+	}
+};
+
+template<typename T> auto value(T t)
+{
+	return t;
+}
+
+template<typename T> auto value(checked<T> t)
+{
+	return t.v_;
+}
+
+// appends a decimal digit, so a checked T throws rather than wrap
+template<typename T> T push_digit(T v, char c)
+{
+	return v * T(10) + T(c - '0');
+}
+
+template<typename T> T to_num(std::string_view s)
+{
+	return std::ranges::fold_left(s, T(0), push_digit<T>);
+}
+
+template<typename T> int bits(T t)
+{
+	auto v = static_cast<unsigned __int128>(value(t));
+	auto hi = uint64_t(v >> 64);
+	return hi ? 64 + int(std::bit_width(hi)) : int(std::bit_width(uint64_t(v)));
+}
+
+// conservative pre-pass. A problem's total is below 2^b, where b is the sum of its
+// operands' bit widths for a product, and the widest plus bit_width(operands) for a sum.
+// The grand total is then below the sum of the 2^b.
+//
+template<typename T> bool fits64(sums<T> const& sm)
+{
+	using u128 = unsigned __int128;
+	u128 bound = 0;
+	for(auto const& s : sm)
+	{
+		int b = 0;
+		if(s.prod_)
+			b = std::max(1, std::ranges::fold_left(s.vars_, 0, [](auto b, auto v){ return b + bits(v);}));
+		else
+			b = std::ranges::fold_left(s.vars_, 0, [](auto b, auto v){ return std::max(b, bits(v));}) + int(std::bit_width(s.vars_.size()));
+		if(b > 63)
+			return false;
+		bound += u128(1) << b;
+	}
+	return bound <= u128(1) << 63;
+}
+
+// folds operands of type T in type F
+template<typename F, typename T> F fold_sums(sums<T> const& sm)
+{
+	return std::ranges::fold_left(sm, F(0),
+		[](F t, auto& s)
+		{
+			if(s.prod_)
+				return t + std::ranges::fold_left(s.vars_, F(1), [](F a, T v){ return a * F(value(v));});
+			return t + std::ranges::fold_left(s.vars_, F(0), [](F a, T v){ return a + F(value(v));});
+		});
+}
+
+// stays on the 64 bit path unless the pre-pass says it might not be enough
+template<typename T> T reduce(sums<T> const& sm)
+{
+	if constexpr (!std::is_same_v<T, int64_t>)
+		if(fits64(sm))
+			return T(fold_sums<int64_t>(sm));
+	return fold_sums<T>(sm);
+}
 
 auto get_input()
 {
@@ -26,9 +129,9 @@ auto get_input()
 	return r;
 }
 
-sums proc_pt1(std::vector<std::string> const& ss)
+template<typename T> sums<T> proc_pt1(std::vector<std::string> const& ss)
 {
-	sums sm;
+	sums<T> sm;
 	for(auto v : ctre::search_all<"([+*])">(ss.back()))
 	{
 		sm.emplace_back();
@@ -39,7 +142,7 @@ sums proc_pt1(std::vector<std::string> const& ss)
 		auto it = sm.begin();
 		for(auto v : ctre::search_all<"(\\d+)">(s))
 		{
-			(*it).vars_.push_back(v.to_number<int64_t>());
+			(*it).vars_.push_back(to_num<T>(v.view()));
 			++it;
 		}
 	}
@@ -47,42 +150,35 @@ sums proc_pt1(std::vector<std::string> const& ss)
 	return sm;
 }
 
-int64_t pt1(auto const& in)
+template<typename T> T pt1(auto const& in)
 {
 	timer t("p1");
-	return std::ranges::fold_left(proc_pt1(in), 0LL, 
-		[](auto t, auto& sm)
-		{
-			if(sm.prod_)
-				return t + std::ranges::fold_left(sm.vars_, 1LL, std::multiplies());
-			 return t + std::ranges::fold_left(sm.vars_, 0LL, std::plus());
-		});
+	return reduce<T>(proc_pt1<T>(in));
 }
 
-sums proc_pt2(std::vector<std::string> const& ss)
+template<typename T> sums<T> proc_pt2(std::vector<std::string> const& ss)
 {
-	sums sm;
+	sums<T> sm;
 	for(auto v : ctre::search_all<"([+*])">(ss.back()))
 	{
 		sm.emplace_back();
 		sm.back().prod_ = v.view()[0] == '*';
 	}
 	auto its = sm.begin();
-	int64_t v = 0;
+	T v = T(0);
 	for(size_t pt = 0; pt < ss.front().size(); ++pt)
 	{
 		bool all_space = true;
-		v = 0;
+		v = T(0);
 		for(size_t sn = 0; sn < ss.size() - 1; ++sn)
 		{
 			if( ss[sn][pt] != ' ')
 			{
 				all_space = false;
-				v *= 10;
-				v += ss[sn][pt] - '0';
+				v = push_digit(v, ss[sn][pt]);
 			}
 		}
-		if(v != 0)
+		if(value(v) != 0)
 			(*its).vars_.push_back(v);
 		if(all_space)
 			++its;
@@ -90,23 +186,274 @@ sums proc_pt2(std::vector<std::string> const& ss)
 	return sm;
 }
 
-int64_t pt2(auto const& in)
+template<typename T> T pt2(auto const& in)
 {
 	timer t("p2");
-	return std::ranges::fold_left(proc_pt2(in), 0LL, 
-		[](auto t, auto& sm)
+	return reduce<T>(proc_pt2<T>(in));
+}
+
+// fused parse and reduce, straight from the stream. Only running totals are kept,
+// a sum and product per problem for pt1 and the vertical number being built in
+// each character column for pt2. Operands are folded in as they are read.
+// There's nothing left to pre-pass so T is used throughout. The operator isn't known
+// until the end so a checked overflow is only reported if that total is asked for.
+//
+template<typename T> struct acc_t
+{
+	T sum_ = T(0);
+	T prod_ = T(1);
+	bool sovf_ = false;
+	bool povf_ = false;
+	void add(T v)
+	{
+		try
 		{
-			if(sm.prod_)
-				return t + std::ranges::fold_left(sm.vars_, 1LL, std::multiplies());
-			 return t + std::ranges::fold_left(sm.vars_, 0LL, std::plus());
-		});
+			if(!sovf_)
+				sum_ = sum_ + v;
+		}
+		catch(std::overflow_error&)
+		{
+			sovf_ = true;
+		}
+		try
+		{
+			if(!povf_)
+				prod_ = prod_ * v;
+		}
+		catch(std::overflow_error&)
+		{
+			povf_ = true;
+		}
+	}
+	T get(char op) const
+	{
+		if(op == '*')
+		{
+			if(povf_)
+				throw std::overflow_error("product overflow");
+			return prod_;
+		}
+		if(sovf_)
+			throw std::overflow_error("sum overflow");
+		return sum_;
+	}
+};
+
+template<typename T> auto pt12_stream(std::istream& is)
+{
+	timer t("p12 stream");
+	std::vector<acc_t<T>> pr;
+	std::vector<T> col;
+	std::vector<bool> dig;
+	std::string ln;
+	while(std::getline(is, ln))
+	{
+		if(ln.find_first_of("+*") != std::string::npos)
+			break;
+		auto it = pr.begin();
+		for(auto v : ctre::search_all<"(\\d+)">(ln))
+		{
+			if(it == pr.end())
+				it = pr.emplace(it);
+			(*it).add(to_num<T>(v.view()));
+			++it;
+		}
+		if(col.size() < ln.size())
+		{
+			col.resize(ln.size(), T(0));
+			dig.resize(ln.size(), false);
+		}
+		for(size_t pt = 0; pt < ln.size(); ++pt)
+		{
+			if(ln[pt] != ' ')
+			{
+				col[pt] = push_digit(col[pt], ln[pt]);
+				dig[pt] = true;
+			}
+		}
+	}
+	// ln now holds the operators
+	T p1 = T(0);
+	T p2 = T(0);
+	auto its = pr.begin();
+	acc_t<T> a;
+	size_t pt = 0;
+	for(auto v : ctre::search_all<"([+*])">(ln))
+	{
+		auto op = v.view()[0];
+		p1 = p1 + (*its).get(op);
+		++its;
+		a = acc_t<T>();
+		for( ; pt < col.size() && dig[pt]; ++pt)
+			if(value(col[pt]) != 0)
+				a.add(col[pt]);
+		p2 = p2 + a.get(op);
+		++pt;
+	}
+	return std::make_pair(p1, p2);
+}
+
+// two phase parallel engine. First find the separator columns by OR-ing a 'not space'
+// mask down the rows, a byte loop the compiler vectorises. Then contiguous runs of
+// problems go to threads, each doing both parts for its range, and the partial totals
+// are summed at the end.
+//
+using range_t = std::pair<size_t, size_t>;
+
+std::vector<range_t> find_problems(std::vector<std::string> const& ss)
+{
+	size_t w = 0;
+	for(auto const& s : ss)
+		w = std::max(w, s.size());
+	std::vector<uint8_t> used(w, 0);
+	for(size_t sn = 0; sn < ss.size() - 1; ++sn)
+	{
+		auto u = used.data();
+		auto c = ss[sn].data();
+		auto sz = ss[sn].size();
+		for(size_t pt = 0; pt < sz; ++pt)
+			u[pt] |= c[pt] != ' ';
+	}
+	std::vector<range_t> r;
+	size_t pt = 0;
+	while(pt < w)
+	{
+		while(pt < w && !used[pt])
+			++pt;
+		if(pt == w)
+			break;
+		auto b = pt;
+		while(pt < w && used[pt])
+			++pt;
+		r.emplace_back(b, pt);
+	}
+	return r;
 }
 
-int main()
+template<typename T> std::pair<T, T> eval_problem(std::vector<std::string> const& ss, range_t rg)
 {
-	auto in = get_input();
-	auto p1 = pt1(in);
-	auto p2 = pt2(in);
-	fmt::println("pt1 = {}", p1);
-	fmt::println("pt2 = {}", p2);
-}
\ No newline at end of file
+	auto[b, e] = rg;
+	auto const& ops = ss.back();
+	bool prod = false;
+	for(auto pt = b; pt < e && pt < ops.size(); ++pt)
+		if(ops[pt] == '*')
+			prod = true;
+	auto op = [prod](T a, T v){ return prod ? a * v : a + v;};
+	T p1 = prod ? T(1) : T(0);
+	T p2 = p1;
+	for(size_t sn = 0; sn < ss.size() - 1; ++sn)
+	{
+		T v = T(0);
+		bool dig = false;
+		for(auto pt = b; pt < e && pt < ss[sn].size(); ++pt)
+		{
+			if(ss[sn][pt] != ' ')
+			{
+				v = push_digit(v, ss[sn][pt]);
+				dig = true;
+			}
+		}
+		if(dig)
+			p1 = op(p1, v);
+	}
+	for(auto pt = b; pt < e; ++pt)
+	{
+		T v = T(0);
+		for(size_t sn = 0; sn < ss.size() - 1; ++sn)
+			if(pt < ss[sn].size() && ss[sn][pt] != ' ')
+				v = push_digit(v, ss[sn][pt]);
+		if(value(v) != 0)
+			p2 = op(p2, v);
+	}
+	return { p1, p2 };
+}
+
+template<typename T> auto pt12_par(std::vector<std::string> const& ss)
+{
+	timer t("p12 par");
+	auto pr = find_problems(ss);
+	size_t nt = std::max(1u, std::thread::hardware_concurrency());
+	size_t chunk = std::max<size_t>(1, (pr.size() + nt - 1) / nt);
+	std::vector<std::future<std::pair<T, T>>> fs;
+	for(size_t b = 0; b < pr.size(); b += chunk)
+		fs.emplace_back(std::async(std::launch::async, [&, b]()
+			{
+				std::pair<T, T> r{ T(0), T(0) };
+				for(auto n = b; n < std::min(b + chunk, pr.size()); ++n)
+				{
+					auto[a1, a2] = eval_problem<T>(ss, pr[n]);
+					r.first = r.first + a1;
+					r.second = r.second + a2;
+				}
+				return r;
+			}));
+	T p1 = T(0);
+	T p2 = T(0);
+	for(auto& f : fs)
+	{
+		auto[a1, a2] = f.get();
+		p1 = p1 + a1;
+		p2 = p2 + a2;
+	}
+	return std::make_pair(p1, p2);
+}
+
+template<typename T> void run(bool stream, bool par)
+{
+	try
+	{
+		if(stream)
+		{
+			auto[p1, p2] = pt12_stream<T>(std::cin);
+			fmt::println("pt1 = {}", value(p1));
+			fmt::println("pt2 = {}", value(p2));
+			return;
+		}
+		auto in = get_input();
+		if(par)
+		{
+			auto[p1, p2] = pt12_par<T>(in);
+			fmt::println("pt1 = {}", value(p1));
+			fmt::println("pt2 = {}", value(p2));
+			return;
+		}
+		auto p1 = pt1<T>(in);
+		auto p2 = pt2<T>(in);
+		fmt::println("pt1 = {}", value(p1));
+		fmt::println("pt2 = {}", value(p2));
+	}
+	catch(std::overflow_error& e)
+	{
+		fmt::println("{}", e.what());
+	}
+}
+
+// -s stream, -p parallel, -c checked arithmetic, -w 128 bit arithmetic, -c -w both
+//
+int main(int ac, char* av[])
+{
+	bool stream = false;
+	bool par = false;
+	bool chk = false;
+	bool wide = false;
+	for(int n = 1; n < ac; ++n)
+	{
+		std::string_view a(av[n]);
+		if(a == "-s")
+			stream = true;
+		else if(a == "-p")
+			par = true;
+		else if(a == "-c")
+			chk = true;
+		else if(a == "-w")
+			wide = true;
+	}
+	if(chk && wide)
+		run<checked<__int128>>(stream, par);
+	else if(wide)
+		run<__int128>(stream, par);
+	else if(chk)
+		run<checked<int64_t>>(stream, par);
+	else
+		run<int64_t>(stream, par);
+}
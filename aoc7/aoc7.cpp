@@ -5,73 +5,494 @@
 #include <algorithm>
 #include <numeric>
 #include <ranges>
+#include <bit>
+#include <string_view>
+#include <sstream>
 
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 
 #include "ctre_inc.h"
 #include "timer.h"
+#include "wide_uint.h"
 
-auto get_input()
+// timeline counts modulo M. live_ remembers that something other than zero was
+// added, a count that lands on a multiple of M is still a beam.
+//
+template<uint64_t M> struct mod_t
 {
-	std::vector<int64_t> v;
+	uint64_t v_ = 0;
+	bool live_ = false;
+
+	mod_t() = default;
+	mod_t(uint64_t v) : v_{ v % M }, live_{ v != 0 }
+	{
+	}
+	mod_t& operator+=(mod_t const& o)
+	{
+		v_ = (v_ + o.v_) % M;
+		live_ = live_ || o.live_;
+		return *this;
+	}
+	friend mod_t operator+(mod_t a, mod_t const& b)
+	{
+		return a += b;
+	}
+	explicit operator bool() const
+	{
+		return live_;
+	}
+};
+
+template<size_t N> struct fmt::formatter<wide_uint<N>> : fmt::formatter<std::string>
+{
+	auto format(wide_uint<N> const& v, format_context& ctx) const
+	{
+		return fmt::formatter<std::string>::format(v.to_string(), ctx);
+	}
+};
+
+template<uint64_t M> struct fmt::formatter<mod_t<M>> : fmt::formatter<uint64_t>
+{
+	auto format(mod_t<M> const& v, format_context& ctx) const
+	{
+		return fmt::formatter<uint64_t>::format(v.v_, ctx);
+	}
+};
+
+auto get_input(std::istream& is)
+{
+	std::vector<char> v;
 	size_t stride = 0;
 	std::string ln;
-	while(std::getline(std::cin, ln))
+	while(std::getline(is, ln))
 	{
 		if(stride == 0)
 			stride = ln.size();
-		auto os = v.size();
-		v.resize(v.size() + stride);
-		std::ranges::transform(ln, v.begin() + os, [](auto c){ if(c == 'S') return 1; if (c == '^') return -1; return 0;});
+		ln.resize(stride, '.');
+		v.append_range(ln);
 	}
 	return std::make_pair(stride, v);
 }
 
-int op(auto const& a, auto const& b)
+// timeline counts for the row below from the counts in a and the text of that row.
+// T is the count type, anything with +=, + and a test for zero.
+//
+template<typename T> int op(std::string_view ln, std::vector<T> const& a, std::vector<T>& b)
 {
-	auto ita = a.begin();
-	auto itb = b.begin();
+	std::ranges::fill(b, T());
 	int p1 = 0;
-	for( ; ita != a.end(); ++ita, ++itb)
+	for(size_t n = 0; n < a.size(); ++n)
 	{
-		if(*itb < 0)
+		if(!a[n])
+			continue;
+		if(n < ln.size() && ln[n] == '^')
 		{
-			*(itb - 1) += (*ita);
-			*(itb + 1) += (*ita);
-			p1 += *ita > 0;
+			if(n > 0)
+				b[n - 1] += a[n];
+			if(n + 1 < b.size())
+				b[n + 1] += a[n];
+			++p1;
 		}
 		else
-		if(*ita > 0)
-			*itb += *ita;
+			b[n] += a[n];
 	}
 	return p1;
 }
 
-auto pt12(auto const& in)
+template<typename T> T total(std::vector<T> const& a)
+{
+	return std::ranges::fold_left(a, T(), [](T sm, T const& v){ return sm + v;});
+}
+
+template<typename T> std::pair<int64_t, T> pt12(auto const& in)
+{
+	auto const& [stride, grid] = in;
+	std::vector<T> a(stride);
+	std::vector<T> b(stride);
+	for(size_t n = 0; n < stride; ++n)
+		if(grid[n] == 'S')
+			a[n] = T(1);
+	int64_t p1 = 0;
+	for(auto it = grid.begin() + stride; it != grid.end(); it += stride)
+	{
+		p1 += op(std::string_view(&*it, stride), a, b);
+		std::swap(a, b);
+	}
+	return { p1, total(a) };
+}
+
+// character pt1, the first go at this. Beams are drawn into the grid as '|' and the
+// splitters hit are marked '+' in a scratch row and counted.
+//
+void op_chars(auto const& a, auto const& b, auto& out)
+{
+	auto ita = a.begin();
+	auto itb = b.begin();
+	auto ito = out.begin();
+	for( ; ita != a.end(); ++ita, ++itb, ++ito)
+	{
+		if(*ita == 'S')
+			*itb = '|';
+		if(*ita == '|')
+		{
+			if(*itb == '^')
+			{
+				*ito = '+';
+				*(itb - 1) = '|';
+				*(itb + 1) = '|';
+			}
+			else
+			{
+				*itb = '|';
+			}
+		}
+	}
+}
+
+int64_t pt1_chars(auto const& in)
 {
-	timer t("p12");
 	auto[stride, grid] = in;
 	auto ita = grid.begin();
 	auto itb = grid.begin() + stride;
-	int pt1 = 0;
+	int64_t pt1 = 0;
+	std::vector<char> tmp(stride, '.');
 	while(itb != grid.end())
 	{
+		std::ranges::fill(tmp, '.');
 		std::span a(ita, stride);
 		std::span b(itb, stride);
-		pt1 += op(a, b);
+		op_chars(a, b, tmp);
+		pt1 += std::ranges::count(tmp, '+');
 		ita = itb;
 		itb += stride;
+	}
+	return pt1;
+}
+
+// bit packed pt1. Beams and splitters are rows of 64 bit words, bit n is column n,
+// and each row transition is a handful of shifts and masks,
+//
+//   hits = beams & splitters
+//   next = (beams & ~splitters) | (hits << 1) | (hits >> 1)
+//
+// with the splits counted by popcount(hits). There are no timeline counts so no pt2.
+//
+struct packed_t
+{
+	size_t stride_ = 0;
+	size_t words_ = 0;
+	std::vector<uint64_t> start_;
+	std::vector<uint64_t> split_; // words_ per row
+};
+
+auto get_packed(std::istream& is)
+{
+	packed_t p;
+	std::string ln;
+	while(std::getline(is, ln))
+	{
+		if(p.stride_ == 0)
+		{
+			p.stride_ = ln.size();
+			p.words_ = (p.stride_ + 63) / 64;
+			p.start_.resize(p.words_, 0);
+		}
+		auto os = p.split_.size();
+		p.split_.resize(os + p.words_, 0);
+		for(size_t n = 0; n < ln.size() && n < p.stride_; ++n)
+		{
+			if(ln[n] == '^')
+				p.split_[os + n / 64] |= 1ULL << (n % 64);
+			else if(ln[n] == 'S')
+				p.start_[n / 64] |= 1ULL << (n % 64);
+		}
+	}
+	return p;
+}
+
+int64_t pt1_bits(packed_t const& p)
+{
+	const auto w = p.words_;
+	// clears anything shifted out past the last column
+	const uint64_t last = p.stride_ % 64 ? (1ULL << (p.stride_ % 64)) - 1 : ~0ULL;
+	std::vector<uint64_t> beams(p.start_);
+	std::vector<uint64_t> hits(w);
+	int64_t p1 = 0;
+	for(auto it = p.split_.begin(); it != p.split_.end(); it += w)
+	{
+		for(size_t n = 0; n < w; ++n)
+		{
+			hits[n] = beams[n] & it[n];
+			p1 += std::popcount(hits[n]);
+		}
+		for(size_t n = 0; n < w; ++n)
+		{
+			auto l = (hits[n] << 1) | (n > 0 ? hits[n - 1] >> 63 : 0);
+			auto r = (hits[n] >> 1) | (n + 1 < w ? hits[n + 1] << 63 : 0);
+			beams[n] = (beams[n] & ~it[n]) | l | r;
+		}
+		beams[w - 1] &= last;
+	}
+	return p1;
+}
+
+// streaming pt12. One row of text at a time and two rows of timeline counts, swapped
+// after each row, so memory is O(width) however tall the manifold.
+//
+template<typename T> std::pair<int64_t, T> pt12_stream(std::istream& is)
+{
+	std::vector<T> a;
+	std::vector<T> b;
+	std::string ln;
+	if(std::getline(is, ln))
+	{
+		a.resize(ln.size());
+		b.resize(ln.size());
+		for(size_t n = 0; n < ln.size(); ++n)
+			if(ln[n] == 'S')
+				a[n] = T(1);
+	}
+	int64_t p1 = 0;
+	while(std::getline(is, ln))
+	{
+		p1 += op(ln, a, b);
+		std::swap(a, b);
+	}
+	return { p1, total(a) };
+}
+
+// sparse pt12 for mostly empty manifolds. The active beams are a sorted (column, count)
+// list and each row's splitters a sorted list of columns. A row transition merges the
+// two so the cost follows beams plus splitters rather than the width.
+//
+template<typename T> using beams_t = std::vector<std::pair<int64_t, T>>;
+
+// splitters side by side can put a beam one column behind the last, never further
+template<typename T> void add_beam(beams_t<T>& b, int64_t c, T const& v)
+{
+	if(b.empty() || b.back().first < c)
+		b.emplace_back(c, v);
+	else if(b.back().first == c)
+		b.back().second += v;
+	else if(b.size() > 1 && b[b.size() - 2].first == c)
+		b[b.size() - 2].second += v;
+	else
+		b.insert(b.end() - 1, { c, v });
+}
+
+template<typename T> int op_sparse(std::vector<int64_t> const& s, beams_t<T> const& a, beams_t<T>& b, int64_t w)
+{
+	b.clear();
+	int p1 = 0;
+	auto is = s.begin();
+	for(auto const& [c, v] : a)
+	{
+		while(is != s.end() && *is < c)
+			++is;
+		if(is != s.end() && *is == c)
+		{
+			if(c > 0)
+				add_beam(b, c - 1, v);
+			if(c + 1 < w)
+				add_beam(b, c + 1, v);
+			++p1;
+		}
+		else
+			add_beam(b, c, v);
+	}
+	return p1;
+}
+
+template<typename T> std::pair<int64_t, T> pt12_sparse(std::istream& is)
+{
+	beams_t<T> a;
+	beams_t<T> b;
+	std::vector<int64_t> s;
+	int64_t w = 0;
+	std::string ln;
+	if(std::getline(is, ln))
+	{
+		w = ln.size();
+		for(auto n = ln.find('S'); n != std::string::npos; n = ln.find('S', n + 1))
+			a.emplace_back(n, T(1));
+	}
+	int64_t p1 = 0;
+	while(std::getline(is, ln))
+	{
+		s.clear();
+		for(auto n = ln.find('^'); n != std::string::npos; n = ln.find('^', n + 1))
+			s.emplace_back(n);
+		if(s.empty())
+			continue;
+		p1 += op_sparse(s, a, b, w);
+		std::swap(a, b);
+	}
+	return { p1, std::ranges::fold_left(a, T(), [](T sm, auto const& bm){ return sm + bm.second;}) };
+}
+
+// the sparse form parsed up front, for timing the propagation alone. The start columns
+// and the splitter columns of each row that has any.
+//
+struct sparse_t
+{
+	int64_t w_ = 0;
+	std::vector<int64_t> start_;
+	std::vector<std::vector<int64_t>> split_;
+};
+
+auto get_sparse(std::istream& is)
+{
+	sparse_t sp;
+	std::string ln;
+	if(std::getline(is, ln))
+	{
+		sp.w_ = ln.size();
+		for(auto n = ln.find('S'); n != std::string::npos; n = ln.find('S', n + 1))
+			sp.start_.emplace_back(n);
+	}
+	while(std::getline(is, ln))
+	{
+		std::vector<int64_t> s;
+		for(auto n = ln.find('^'); n != std::string::npos; n = ln.find('^', n + 1))
+			s.emplace_back(n);
+		if(!s.empty())
+			sp.split_.emplace_back(std::move(s));
+	}
+	return sp;
+}
 
+template<typename T> std::pair<int64_t, T> pt12_sparse(sparse_t const& sp)
+{
+	beams_t<T> a;
+	beams_t<T> b;
+	for(auto c : sp.start_)
+		a.emplace_back(c, T(1));
+	int64_t p1 = 0;
+	for(auto const& s : sp.split_)
+	{
+		p1 += op_sparse(s, a, b, sp.w_);
+		std::swap(a, b);
 	}
-	std::span a(ita, stride);
-	return std::make_pair(pt1, std::ranges::fold_left(a, 0LL, [](auto sm, auto v){if( v > 0) return sm + v; return sm;}));
+	return { p1, std::ranges::fold_left(a, T(), [](T sm, auto const& bm){ return sm + bm.second;}) };
 }
 
-int main()
+// the engines, from manifold text to pt1 and 64 bit pt2. pt1 only engines give 0.
+// prop_ parses once then times the propagation alone on that, giving the result and ns
+// per run. stream has no form apart from the text so has no prop_.
+//
+using result_t = std::pair<int64_t, int64_t>;
+using timed_t = std::pair<result_t, double>;
+
+struct engine_t
+{
+	std::string_view name_;
+	result_t (*run_)(std::istream&);
+	timed_t (*prop_)(std::istream&);
+};
+
+// chars draws into its grid so each run propagates on a fresh copy, as pt1_chars does
+constexpr engine_t engines[] = {
+	{ "chars",  [](std::istream& is) -> result_t { return { pt1_chars(get_input(is)), 0 };},
+				[](std::istream& is){ auto in = get_input(is); return repeat_for(200ms, [&]() -> result_t { return { pt1_chars(in), 0 };});}},
+	{ "cells",  [](std::istream& is) -> result_t { return pt12<int64_t>(get_input(is));},
+				[](std::istream& is){ auto in = get_input(is); return repeat_for(200ms, [&]() -> result_t { return pt12<int64_t>(in);});}},
+	{ "bits",   [](std::istream& is) -> result_t { return { pt1_bits(get_packed(is)), 0 };},
+				[](std::istream& is){ auto p = get_packed(is); return repeat_for(200ms, [&]() -> result_t { return { pt1_bits(p), 0 };});}},
+	{ "stream", [](std::istream& is) -> result_t { return pt12_stream<int64_t>(is);}, nullptr },
+	{ "sparse", [](std::istream& is) -> result_t { return pt12_sparse<int64_t>(is);},
+				[](std::istream& is){ auto sp = get_sparse(is); return repeat_for(200ms, [&]() -> result_t { return pt12_sparse<int64_t>(sp);});}},
+};
+
+// every engine on the same grid, first from the text, parsing included since each has
+// its own representation, then the propagation alone on the parsed form. Each is
+// repeated for at least 200ms to steady the small grids.
+//
+void bench(std::istream& is)
 {
-	auto in = get_input();
-	auto[p1,p2] = pt12(in);
-	fmt::println("pt1 = {}", p1);
-	fmt::println("pt2 = {}", p2);
+	std::ostringstream os;
+	os << is.rdbuf();
+	auto const txt = os.str();
+	auto cells = std::ranges::count_if(txt, [](auto c){ return c != '\n';});
+	fmt::println("{} cells", cells);
+	for(auto const& e : engines)
+	{
+		auto[r, ns] = repeat_for(200ms, [&]{ std::istringstream in(txt); return e.run_(in);});
+		fmt::print("{:>6} : pt1 = {}, pt2 = {}, {:.3f} ns/cell", e.name_, r.first, r.second, ns / cells);
+		if(e.prop_)
+		{
+			std::istringstream in(txt);
+			auto[rp, pns] = e.prop_(in);
+			fmt::print(", propagation {:.3f} ns/cell", pns / cells);
+		}
+		fmt::println("");
+	}
+}
+
+template<typename T> void run(char engine)
+{
+	std::pair<int64_t, T> r;
+	if(engine == 's')
+	{
+		timer t("p12 stream");
+		r = pt12_stream<T>(std::cin);
+	}
+	else if(engine == 'x')
+	{
+		timer t("p12 sparse");
+		r = pt12_sparse<T>(std::cin);
+	}
+	else
+	{
+		auto in = get_input(std::cin);
+		timer t("p12");
+		r = pt12<T>(in);
+	}
+	fmt::println("pt1 = {}", r.first);
+	fmt::println("pt2 = {}", r.second);
+}
+
+// engines, -c characters pt1 only, -b bit packed pt1 only, -s streaming, -x sparse,
+// default cells. -B benchmarks them all on the one input.
+// counts are int64_t unless -w unsigned __int128, -n 512 bit, -m modulo 1000000007
+//
+int main(int ac, char* av[])
+{
+	char engine = 0;
+	char count = 0;
+	for(int n = 1; n < ac; ++n)
+	{
+		std::string_view a(av[n]);
+		if(a == "-c" || a == "-b" || a == "-s" || a == "-x" || a == "-B")
+			engine = a[1];
+		else if(a == "-w" || a == "-n" || a == "-m")
+			count = a[1];
+	}
+	if(engine == 'B')
+	{
+		bench(std::cin);
+		return 0;
+	}
+	if(engine == 'c')
+	{
+		auto in = get_input(std::cin);
+		timer t("p1 chars");
+		fmt::println("pt1 = {}", pt1_chars(in));
+		return 0;
+	}
+	if(engine == 'b')
+	{
+		auto in = get_packed(std::cin);
+		timer t("p1 bits");
+		fmt::println("pt1 = {}", pt1_bits(in));
+		return 0;
+	}
+	if(count == 'w')
+		run<unsigned __int128>(engine);
+	else if(count == 'n')
+		run<wide_uint<8>>(engine);
+	else if(count == 'm')
+		run<mod_t<1'000'000'007>>(engine);
+	else
+		run<int64_t>(engine);
 }
@@ -1,15 +1,31 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <unordered_set>
 #include <algorithm>
 #include <numeric>
 #include <ranges>
+#include <functional>
+#include <iterator>
+#include <cmath>
+#include <numbers>
+#include <string_view>
+#include <tuple>
+#include <limits>
+#include <array>
+#include <span>
+#include <bit>
+#include <thread>
+#include <future>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #include <fmt/format.h>
 
 #include "ctre_inc.h"
 #include "timer.h"
+#include "disjoint_set.h"
 
 struct pt_t
 {
@@ -38,139 +54,637 @@ auto get_input()
 	return v;
 }
 
-constexpr int64_t kv = 1024;
+// a pair of points in 12 bytes, good for 2^32 points. The key is the bits of d2 as a
+// float, which orders like d2 as an unsigned but can round close distances together.
+//
+struct pr_t
+{
+	uint32_t a_;
+	uint32_t b_;
+	uint32_t k_;
+};
+
+uint32_t d2_key(int64_t d)
+{
+	return std::bit_cast<uint32_t>(static_cast<float>(d));
+}
+
+int64_t d2(std::vector<pt_t> const& p, pr_t r)
+{
+	return d2(p[r.a_], p[r.b_]);
+}
 
-auto xy_k(auto x, auto y)
+// in place MSD radix sort on an unsigned key, American flag style. 8 bits a digit,
+// from the highest digit the largest key uses. Each pass counts its digit then swaps
+// every element into its bucket by following cycles, so the only extra memory is the
+// counts and a pair record costs its 12 bytes, no more. Small buckets are insertion
+// sorted. Not stable, fix_ties only needs equal keys together.
+//
+template<typename T> void radix_sort(std::span<T> v, auto key, int sh)
 {
-	return y * kv + x;
+	auto digit = [&](T const& e){ return (uint64_t(std::invoke(key, e)) >> sh) & 0xff;};
+	if(v.size() < 32)
+	{
+		for(size_t n = 1; n < v.size(); ++n)
+			for(auto m = n; m > 0 && std::invoke(key, v[m]) < std::invoke(key, v[m - 1]); --m)
+				std::swap(v[m], v[m - 1]);
+		return;
+	}
+	std::array<size_t, 256> cnt{};
+	for(auto const& e : v)
+		++cnt[digit(e)];
+	std::array<size_t, 256> hd;
+	std::array<size_t, 256> tl;
+	size_t at = 0;
+	for(size_t b = 0; b < 256; ++b)
+	{
+		hd[b] = at;
+		at += cnt[b];
+		tl[b] = at;
+	}
+	// carry each misplaced element round its cycle until one belongs where it started
+	for(size_t b = 0; b < 256; ++b)
+		while(hd[b] < tl[b])
+		{
+			auto e = v[hd[b]];
+			for(auto d = digit(e); d != b; d = digit(e))
+				std::swap(e, v[hd[d]++]);
+			v[hd[b]++] = e;
+		}
+	if(sh == 0)
+		return;
+	at = 0;
+	for(size_t b = 0; b < 256; ++b)
+	{
+		if(cnt[b] > 1)
+			radix_sort(v.subspan(at, cnt[b]), key, sh - 8);
+		at += cnt[b];
+	}
 }
 
-auto k_xy(auto k)
+template<typename T> void radix_sort(std::vector<T>& v, auto key)
 {
-	return std::make_pair(k % kv, k / kv );
+	uint64_t mx = 0;
+	for(auto const& e : v)
+		mx = std::max<uint64_t>(mx, std::invoke(key, e));
+	if(mx == 0)
+		return;
+	radix_sort(std::span<T>(v), key, (int(std::bit_width(mx)) - 1) / 8 * 8);
+}
+
+// after the radix sort on the key, put any runs the key rounded together in exact order
+void fix_ties(std::vector<pr_t>& r, std::vector<pt_t> const& p)
+{
+	for(auto b = r.begin(); b != r.end(); )
+	{
+		auto e = std::find_if(b + 1, r.end(), [&](auto const& x){ return x.k_ != (*b).k_;});
+		if(e - b > 1)
+			std::sort(b, e, [&](auto const& l, auto const& rr){ return d2(p, l) < d2(p, rr);});
+		b = e;
+	}
 }
 
 auto compute_distances(std::vector<pt_t> const& p)
 {
 	timer t("compute distances");
 	const auto st = p.size();
-	std::vector<std::pair<int64_t, int64_t>> r;
-	r.reserve(st * st);
-	for(auto y = 0; y < p.size() - 1; ++y)
-		for(auto x = y + 1; x < p.size(); ++x)
-		{
-			auto d = d2(p[x], p[y]);
-			r.emplace_back(d, xy_k(x, y));
-		}
-	std::ranges::sort(r, std::less(), &std::pair<int64_t, int64_t>::first);
+	std::vector<pr_t> r;
+	r.reserve(st * (st - 1) / 2);
+	for(uint32_t y = 0; y < p.size() - 1; ++y)
+		for(uint32_t x = y + 1; x < p.size(); ++x)
+			r.emplace_back(x, y, d2_key(d2(p[x], p[y])));
+	radix_sort(r, &pr_t::k_);
+	fix_ties(r, p);
 	return r;
 }
 
-int64_t pt1(auto const& in, auto const& d)
+// lazily yields pairs in increasing d2 order without building all of them. Points are
+// bucketed in a uniform grid of cell size r so every pair closer than r is in the same or
+// a neighbouring cell. Pairs in the band (lo_, r^2] are collected, sorted and handed out,
+// then r grows and the next band is collected. The first r is chosen to expect a few
+// pairs per point.
+//
+class near_pairs
 {
-	timer t("p1");
-//	auto d = compute_distances(in);
-	std::vector<std::unordered_set<int64_t>> ss;
-	const auto nd = (in.size() < 1000 ? 10 : 1000);
-	for(int n = 0; n < nd; ++n)
-	{
-		auto[a, b] = k_xy(d[n].second);
-		auto ai = ss.end();
-		auto bi = ss.end();
-		for(auto is = ss.begin(); is != ss.end(); ++is)
+	std::vector<pt_t> const& p_;
+	pt_t mn_;
+	int64_t maxd2_;
+	int64_t lo_ = -1;
+	int64_t hi_;
+	std::vector<pr_t> band_;
+	size_t at_ = 0;
+
+	struct cell_t
+	{
+		int64_t x_;
+		int64_t y_;
+		int64_t z_;
+		auto operator<=>(cell_t const&) const = default;
+	};
+
+	void fill()
+	{
+		band_.clear();
+		at_ = 0;
+		while(band_.empty() && lo_ < maxd2_)
 		{
-			if((*is).contains(a))
-				ai = is ;
-			if((*is).contains(b))
-				bi = is;
+			auto c = static_cast<int64_t>(std::ceil(std::sqrt(double(hi_)))) + 1;
+			auto cell = [&](pt_t const& a) { return cell_t{ (a.x_ - mn_.x_) / c, (a.y_ - mn_.y_) / c, (a.z_ - mn_.z_) / c };};
+			std::vector<std::pair<cell_t, int64_t>> cs;
+			cs.reserve(p_.size());
+			for(int64_t n = 0; n < p_.size(); ++n)
+				cs.emplace_back(cell(p_[n]), n);
+			std::ranges::sort(cs);
+			for(int64_t y = 0; y < p_.size(); ++y)
+			{
+				auto cy = cell(p_[y]);
+				for(int64_t dz = -1; dz < 2; ++dz)
+					for(int64_t dy = -1; dy < 2; ++dy)
+						for(int64_t dx = -1; dx < 2; ++dx)
+						{
+							cell_t k{ cy.x_ + dx, cy.y_ + dy, cy.z_ + dz };
+							auto [b, e] = std::ranges::equal_range(cs, k, std::less(), &std::pair<cell_t, int64_t>::first);
+							for(; b != e; ++b)
+							{
+								auto x = (*b).second;
+								if(x <= y)
+									continue;
+								auto d = d2(p_[x], p_[y]);
+								if(d > lo_ && d <= hi_)
+									band_.emplace_back(x, y, d2_key(d));
+							}
+						}
+			}
+			lo_ = hi_;
+			hi_ *= 2;
 		}
-		if(ai == ss.end() && bi == ss.end())
+		std::ranges::sort(band_, std::less(), [&](auto const& r){ return d2(p_, r);});
+	}
+
+public:
+	near_pairs(std::vector<pt_t> const& p) : p_{ p }
+	{
+		pt_t mx = p.front();
+		mn_ = p.front();
+		for(auto const& a : p)
+		{
+			mn_ = { std::min(mn_.x_, a.x_), std::min(mn_.y_, a.y_), std::min(mn_.z_, a.z_) };
+			mx = { std::max(mx.x_, a.x_), std::max(mx.y_, a.y_), std::max(mx.z_, a.z_) };
+		}
+		maxd2_ = d2(mn_, mx);
+		// about four pairs per point for points spread evenly through the bounding box
+		double v = double(mx.x_ - mn_.x_ + 1) * (mx.y_ - mn_.y_ + 1) * (mx.z_ - mn_.z_ + 1);
+		auto r = std::cbrt(6.0 * v / (std::numbers::pi * p.size()));
+		hi_ = std::max<int64_t>(1, static_cast<int64_t>(r * r));
+		fill();
+	}
+
+	struct iterator
+	{
+		using value_type = pr_t;
+		using difference_type = std::ptrdiff_t;
+		near_pairs* g_ = nullptr;
+		value_type const& operator*() const
 		{
-			std::unordered_set<int64_t> ns;
-			ns.insert(a);
-			ns.insert(b);
-			ss.emplace_back(std::move(ns));
+			return g_->band_[g_->at_];
 		}
-		else if(ai == ss.end())
+		iterator& operator++()
 		{
-			(*bi).insert(a);
+			if(++g_->at_ == g_->band_.size())
+				g_->fill();
+			return *this;
 		}
-		else if(bi == ss.end())
+		void operator++(int)
 		{
-			(*ai).insert(b);
+			++*this;
 		}
-		else
+		bool operator==(std::default_sentinel_t) const
 		{
-			if(ai != bi)
-			{
-				(*ai).insert_range(*bi);
-				ss.erase(bi);	
-			}		
+			return g_->at_ == g_->band_.size();
 		}
+	};
+	iterator begin()
+	{
+		return { this };
+	}
+	std::default_sentinel_t end()
+	{
+		return {};
+	}
+};
+
+// brute force all pairs using the whole machine. Points are held as separate x, y, z
+// arrays and each thread takes a run of rows with about the same number of pairs, working
+// through them in tiles and writing to its own part of the pre-sized output. Row y's
+// pairs start at y * N - y * (y + 1) / 2.
+//
+struct soa_t
+{
+	std::vector<int64_t> xs_;
+	std::vector<int64_t> ys_;
+	std::vector<int64_t> zs_;
+};
+
+// d2 from point y to points [x, e). With AVX2 four at a time, the coordinate
+// differences fit in 32 bits so _mm256_mul_epi32 gives exact 64 bit squares.
+void d2_row(soa_t const& p, int64_t y, int64_t x, int64_t e, pr_t* out)
+{
+#if defined(__AVX2__)
+	const auto yx = _mm256_set1_epi64x(p.xs_[y]);
+	const auto yy = _mm256_set1_epi64x(p.ys_[y]);
+	const auto yz = _mm256_set1_epi64x(p.zs_[y]);
+	alignas(32) int64_t dd[4];
+	for(; x + 4 <= e; x += 4, out += 4)
+	{
+		auto dx = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p.xs_.data() + x)), yx);
+		auto dy = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p.ys_.data() + x)), yy);
+		auto dz = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(p.zs_.data() + x)), yz);
+		auto d = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epi32(dx, dx), _mm256_mul_epi32(dy, dy)), _mm256_mul_epi32(dz, dz));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(dd), d);
+		for(int n = 0; n < 4; ++n)
+			out[n] = { uint32_t(x + n), uint32_t(y), d2_key(dd[n]) };
+	}
+#endif
+	for(; x < e; ++x, ++out)
+	{
+		auto dx = p.xs_[x] - p.xs_[y];
+		auto dy = p.ys_[x] - p.ys_[y];
+		auto dz = p.zs_[x] - p.zs_[y];
+		*out = { uint32_t(x), uint32_t(y), d2_key(dx * dx + dy * dy + dz * dz) };
 	}
-	std::ranges::sort(ss, [](auto& l, auto& r){ return l.size() > r.size();});
-	int64_t p1 = 1;
-	for(int n = 0; n < 3; ++n)
-		p1 *= ss[n].size();
-	return p1;
 }
 
-int64_t pt2(auto const& in, auto const& d)
+auto compute_distances_par(std::vector<pt_t> const& p)
 {
-	timer t("p2");
-//	auto d = compute_distances(in);
-	std::vector<std::unordered_set<int64_t>> ss;
-	int64_t p2 = 0;
-	for(auto n = 0; n < d.size(); ++n)
+	timer t("compute distances par");
+	const int64_t st = p.size();
+	soa_t s;
+	for(auto const& a : p)
+	{
+		s.xs_.emplace_back(a.x_);
+		s.ys_.emplace_back(a.y_);
+		s.zs_.emplace_back(a.z_);
+	}
+	std::vector<pr_t> r(st * (st - 1) / 2);
+	auto row = [&](int64_t y){ return y * st - y * (y + 1) / 2;};
+	const int64_t nt = std::max(1u, std::thread::hardware_concurrency());
+	constexpr int64_t tile = 256;
+	std::vector<std::future<void>> fs;
+	int64_t y0 = 0;
+	for(int64_t n = 0; n < nt && y0 < st; ++n)
 	{
-		auto[a, b] = k_xy(d[n].second);
-		auto ai = ss.end();
-		auto bi = ss.end();
-		for(auto is = ss.begin(); is != ss.end(); ++is)
+		int64_t y1 = y0;
+		while(y1 < st && row(y1) < int64_t(r.size()) * (n + 1) / nt)
+			++y1;
+		if(n == nt - 1)
+			y1 = st;
+		fs.emplace_back(std::async(std::launch::async, [&, y0, y1]()
+			{
+				for(int64_t xb = y0 + 1; xb < st; xb += tile)
+					for(int64_t y = y0; y < y1 && y < xb + tile - 1; ++y)
+					{
+						auto x = std::max(xb, y + 1);
+						auto e = std::min(xb + tile, st);
+						d2_row(s, y, x, e, r.data() + row(y) + (x - y - 1));
+					}
+			}));
+		y0 = y1;
+	}
+	for(auto& f : fs)
+		f.get();
+	radix_sort(r, &pr_t::k_);
+	fix_ties(r, p);
+	return r;
+}
+
+// just the nd shortest pairs, in a max heap of size nd while every pair is visited.
+// O(N^2 + K log K) time and O(K) memory, sorted on the way out.
+//
+auto nearest_k(std::vector<pt_t> const& p, int64_t nd)
+{
+	timer t("nearest k");
+	std::vector<pr_t> r;
+	r.reserve(nd);
+	auto dist = [&](auto const& pr){ return d2(p, pr);};
+	for(uint32_t y = 0; y < p.size() - 1; ++y)
+		for(uint32_t x = y + 1; x < p.size(); ++x)
 		{
-			if((*is).contains(a))
-				ai = is ;
-			if((*is).contains(b))
-				bi = is;
+			auto d = d2(p[x], p[y]);
+			if(r.size() < nd)
+			{
+				r.emplace_back(x, y, d2_key(d));
+				std::ranges::push_heap(r, std::less(), dist);
+			}
+			else if(d < dist(r.front()))
+			{
+				std::ranges::pop_heap(r, std::less(), dist);
+				r.back() = { x, y, d2_key(d) };
+				std::ranges::push_heap(r, std::less(), dist);
+			}
 		}
-		if(ai == ss.end() && bi == ss.end())
+	std::ranges::sort_heap(r, std::less(), dist);
+	return r;
+}
+
+// product of the three largest circuits. With a large K there may be fewer than three left.
+int64_t top3(disjoint_set const& ds)
+{
+	auto sz = ds.sizes();
+	auto top = std::min<size_t>(3, sz.size());
+	std::ranges::partial_sort(sz, sz.begin() + top, std::greater());
+	return std::ranges::fold_left(sz | std::views::take(top), int64_t(1), std::multiplies());
+}
+
+int64_t pt1(auto const& in, auto&& d, int64_t nd)
+{
+	timer t("p1");
+	disjoint_set ds(in.size());
+	for(auto const& r : d | std::views::take(nd))
+		ds.unite(r.a_, r.b_);
+	return top3(ds);
+}
+
+int64_t pt2(auto const& in, auto&& d)
+{
+	timer t("p2");
+	disjoint_set ds(in.size());
+	for(auto const& r : d)
+		if(ds.unite(r.a_, r.b_) && ds.count() == 1)
+			return in[r.a_].x_ * in[r.b_].x_;
+	return 0;
+}
+
+// a single Kruskal pass over the sorted pairs. Each connection, numbered from 1, is
+// offered to every hook with the pair, whether it merged two circuits and the forest.
+// A hook returns false once it has what it wants and the pass ends when none are left
+// or the pairs run out.
+//
+class circuits
+{
+	using hook_t = std::function<bool(int64_t, pr_t const&, bool, disjoint_set const&)>;
+	disjoint_set ds_;
+	std::vector<hook_t> hooks_;
+
+public:
+	explicit circuits(size_t n) : ds_(n)
+	{
+	}
+	void on_connect(hook_t h)
+	{
+		hooks_.emplace_back(std::move(h));
+	}
+	disjoint_set const& forest() const
+	{
+		return ds_;
+	}
+	void run(auto&& d)
+	{
+		int64_t n = 0;
+		for(auto const& r : d)
 		{
-			std::unordered_set<int64_t> ns;
-			ns.insert(a);
-			ns.insert(b);
-			ss.emplace_back(std::move(ns));
+			if(hooks_.empty())
+				break;
+			++n;
+			auto merged = ds_.unite(r.a_, r.b_);
+			std::erase_if(hooks_, [&](auto& h){ return !h(n, r, merged, ds_);});
 		}
-		else if(ai == ss.end())
+	}
+};
+
+// both parts in the one pass, pt1 snapshots the top three after the nd'th connection,
+// or at the end if there are fewer pairs than that, and pt2 is the connection that
+// leaves a single circuit. nc, if set, also reports the number of circuits after nc
+// connections.
+//
+std::pair<int64_t, int64_t> pt12(auto const& in, auto&& d, int64_t nd, int64_t nc)
+{
+	timer t("p12");
+	circuits c(in.size());
+	int64_t p1 = 0;
+	int64_t p2 = 0;
+	bool p1_done = false;
+	c.on_connect([&](int64_t n, pr_t const&, bool, disjoint_set const& ds)
+		{
+			if(n < nd)
+				return true;
+			p1 = top3(ds);
+			p1_done = true;
+			return false;
+		});
+	c.on_connect([&](int64_t, pr_t const& r, bool merged, disjoint_set const& ds)
 		{
-			(*bi).insert(a);
+			if(!merged || ds.count() > 1)
+				return true;
+			p2 = in[r.a_].x_ * in[r.b_].x_;
+			return false;
+		});
+	if(nc > 0)
+		c.on_connect([&](int64_t n, pr_t const&, bool, disjoint_set const& ds)
+			{
+				if(n < nc)
+					return true;
+				fmt::println("{} circuits after {} connections", ds.count(), n);
+				return false;
+			});
+	c.run(d);
+	if(!p1_done)
+		p1 = top3(c.forest());
+	return { p1, p2 };
+}
+
+// pt2 is the longest edge of the Euclidean minimum spanning tree, found here by Boruvka
+// over a k-d tree. Each round every point asks the tree for its nearest neighbour in
+// another circuit, skipping subtrees wholly inside its own, and every circuit takes the
+// shortest edge leaving it. The number of circuits at least halves each round.
+//
+// The tree is implicit, the range [b, e) has its median point at m = (b + e) / 2 split on
+// axis depth % 3, and the bounding box and circuit of the subtree are kept at m.
+//
+class emst
+{
+	using edge_t = std::tuple<int64_t, int64_t, int64_t>; // d2, lower, higher index
+	std::vector<pt_t> const& p_;
+	std::vector<int64_t> idx_;
+	std::vector<pt_t> mn_;
+	std::vector<pt_t> mx_;
+	std::vector<int64_t> comp_; // circuit of a subtree, -1 if mixed
+	std::vector<int64_t> cid_;  // circuit of a point
+
+	static int64_t coord(pt_t const& a, int axis)
+	{
+		return axis == 0 ? a.x_ : axis == 1 ? a.y_ : a.z_;
+	}
+	void build(int64_t b, int64_t e, int depth)
+	{
+		if(b >= e)
+			return;
+		auto m = (b + e) / 2;
+		auto axis = depth % 3;
+		std::nth_element(idx_.begin() + b, idx_.begin() + m, idx_.begin() + e,
+			[&](auto l, auto r){ return coord(p_[l], axis) < coord(p_[r], axis);});
+		build(b, m, depth + 1);
+		build(m + 1, e, depth + 1);
+		mn_[m] = mx_[m] = p_[idx_[m]];
+		for(auto c : { (b + m) / 2, (m + 1 + e) / 2 })
+		{
+			if(c < b || c >= e || c == m)
+				continue;
+			mn_[m] = { std::min(mn_[m].x_, mn_[c].x_), std::min(mn_[m].y_, mn_[c].y_), std::min(mn_[m].z_, mn_[c].z_) };
+			mx_[m] = { std::max(mx_[m].x_, mx_[c].x_), std::max(mx_[m].y_, mx_[c].y_), std::max(mx_[m].z_, mx_[c].z_) };
 		}
-		else if(bi == ss.end())
+	}
+	int64_t label(int64_t b, int64_t e)
+	{
+		if(b >= e)
+			return -2;
+		auto m = (b + e) / 2;
+		auto l = label(b, m);
+		auto r = label(m + 1, e);
+		auto c = cid_[idx_[m]];
+		if((l != -2 && l != c) || (r != -2 && r != c))
+			c = -1;
+		comp_[m] = c;
+		return c;
+	}
+	int64_t box_d2(int64_t m, pt_t const& q) const
+	{
+		auto ax = std::max({ mn_[m].x_ - q.x_, int64_t(0), q.x_ - mx_[m].x_ });
+		auto ay = std::max({ mn_[m].y_ - q.y_, int64_t(0), q.y_ - mx_[m].y_ });
+		auto az = std::max({ mn_[m].z_ - q.z_, int64_t(0), q.z_ - mx_[m].z_ });
+		return ax * ax + ay * ay + az * az;
+	}
+	void nearest(int64_t b, int64_t e, int depth, int64_t q, edge_t& best) const
+	{
+		if(b >= e)
+			return;
+		auto m = (b + e) / 2;
+		if(comp_[m] == cid_[q] || box_d2(m, p_[q]) > std::get<0>(best))
+			return;
+		auto j = idx_[m];
+		if(cid_[j] != cid_[q])
+			best = std::min(best, edge_t{ d2(p_[q], p_[j]), std::min(q, j), std::max(q, j) });
+		auto axis = depth % 3;
+		if(coord(p_[q], axis) < coord(p_[j], axis))
 		{
-			(*ai).insert(b);
+			nearest(b, m, depth + 1, q, best);
+			nearest(m + 1, e, depth + 1, q, best);
 		}
 		else
 		{
-			if(ai != bi)
-			{
-				(*ai).insert_range(*bi);
-				ss.erase(bi);	
-			}		
+			nearest(m + 1, e, depth + 1, q, best);
+			nearest(b, m, depth + 1, q, best);
 		}
-		if(ss[0].size() == in.size())
+	}
+
+public:
+	emst(std::vector<pt_t> const& p) : p_{ p }, idx_(p.size()), mn_(p.size()), mx_(p.size()), comp_(p.size()), cid_(p.size())
+	{
+		std::iota(idx_.begin(), idx_.end(), 0);
+		build(0, p.size(), 0);
+	}
+	// longest edge of the tree, as d2 and the two points
+	edge_t longest()
+	{
+		const auto n = int64_t(p_.size());
+		disjoint_set ds(n);
+		edge_t mx{ -1, 0, 0 };
+		constexpr edge_t none{ std::numeric_limits<int64_t>::max(), 0, 0 };
+		std::vector<edge_t> best(n);
+		while(ds.count() > 1)
 		{
-			p2 = in[a].x_ * in[b].x_;
-			break;
+			for(int64_t q = 0; q < n; ++q)
+				cid_[q] = ds.find(q);
+			label(0, n);
+			std::ranges::fill(best, none);
+			for(int64_t q = 0; q < n; ++q)
+				nearest(0, n, 0, q, best[cid_[q]]);
+			for(auto const& e : best)
+				if(e != none && ds.unite(std::get<1>(e), std::get<2>(e)))
+					mx = std::max(mx, e);
 		}
+		return mx;
 	}
-	return p2;
+};
+
+int64_t pt2_emst(auto const& in)
+{
+	timer t("p2 emst");
+	auto [_, a, b] = emst(in).longest();
+	return in[a].x_ * in[b].x_;
 }
 
-int main()
+// -g lazy grid pairs rather than all pairs sorted
+// -e pt2 from the spanning tree, pt1 from the grid pairs
+// -p pt1 from the nearest K pairs only, pt2 from the spanning tree
+// -k K connections for pt1, otherwise 10 for the example and 1000 for the real thing
+// -t all pairs, sorted, but on every core
+// -c N also report the number of circuits after N connections
+// -v check the spanning tree pt2 against the all pairs one
+//
+int main(int ac, char* av[])
 {
+	bool grid = false;
+	bool tree = false;
+	bool verify = false;
+	bool part = false;
+	bool par = false;
+	int64_t nd = 0;
+	int64_t nc = 0;
+	for(int n = 1; n < ac; ++n)
+	{
+		std::string_view a(av[n]);
+		if(a == "-k" && n + 1 < ac)
+			nd = sv_to_t<int64_t>(av[++n]);
+		else if(a == "-c" && n + 1 < ac)
+			nc = sv_to_t<int64_t>(av[++n]);
+		else if(a == "-p")
+			part = true;
+		else if(a == "-t")
+			par = true;
+		else if(a == "-g")
+			grid = true;
+		else if(a == "-e")
+			tree = true;
+		else if(a == "-v")
+			verify = true;
+	}
 	auto in = get_input();
-	auto d = compute_distances(in);
-	auto p1 = pt1(in, d);
-	auto p2 = pt2(in, d);
+	if(nd == 0)
+		nd = (in.size() < 1000 ? 10 : 1000);
+	if(part)
+	{
+		auto p1 = pt1(in, nearest_k(in, nd), nd);
+		auto p2 = pt2_emst(in);
+		fmt::println("pt1 = {}", p1);
+		fmt::println("pt2 = {}", p2);
+		return 0;
+	}
+	if(verify)
+	{
+		auto pe = pt2_emst(in);
+		auto p2 = pt2(in, compute_distances(in));
+		fmt::println("pt2 = {}, emst {}{}", p2, pe, p2 == pe ? "" : " MISMATCH");
+		return 0;
+	}
+	if(tree)
+	{
+		near_pairs g(in);
+		auto p1 = pt1(in, g, nd);
+		auto p2 = pt2_emst(in);
+		fmt::println("pt1 = {}", p1);
+		fmt::println("pt2 = {}", p2);
+		return 0;
+	}
+	if(grid)
+	{
+		near_pairs g(in);
+		auto[p1, p2] = pt12(in, g, nd, nc);
+		fmt::println("pt1 = {}", p1);
+		fmt::println("pt2 = {}", p2);
+		return 0;
+	}
+	auto d = par ? compute_distances_par(in) : compute_distances(in);
+	auto[p1, p2] = pt12(in, d, nd, nc);
 	fmt::println("pt1 = {}", p1);
 	fmt::println("pt2 = {}", p2);
 }
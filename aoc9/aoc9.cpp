@@ -3,16 +3,29 @@
 #include <vector>
 #include <algorithm>
 #include <numeric>
+#include <limits>
 #include <ranges>
+#include <string_view>
+#include <span>
+#include <array>
+#include <stdexcept>
+#include <random>
+#include <cmath>
+#include <numbers>
+#include <atomic>
+#include <thread>
+#include <future>
 
 #include <fmt/format.h>
 
 #include "ctre_inc.h"
 #include "timer.h"
 
+using pt_t = std::pair<int64_t, int64_t>;
+
 auto get_input()
 {
-	std::vector<std::pair<int64_t, int64_t>> v;
+	std::vector<pt_t> v;
 	std::string ln;
 	while(std::getline(std::cin, ln))
 	{
@@ -76,19 +89,250 @@ auto convex_hull(std::vector<std::pair<int64_t, int64_t>>& points) {
     return stack;
 }
 
-int64_t pt1(auto in)
+// cross product of oa and ob, exactly. 64 bits will do while the coordinates span less
+// than 2^31. Past that it's done in 128 bits, where the differences always fit and the
+// products and their difference are checked, so a turn is never wrong, it throws instead.
+//
+int64_t cross64(pt_t o, pt_t a, pt_t b)
+{
+	return (a.first - o.first) * (b.second - o.second) - (a.second - o.second) * (b.first - o.first);
+}
+
+__int128 cross128(pt_t o, pt_t a, pt_t b)
+{
+	__int128 r1;
+	__int128 r2;
+	__int128 r;
+	if(__builtin_mul_overflow(__int128(a.first) - o.first, __int128(b.second) - o.second, &r1) ||
+		__builtin_mul_overflow(__int128(a.second) - o.second, __int128(b.first) - o.first, &r2) ||
+		__builtin_sub_overflow(r1, r2, &r))
+		throw std::overflow_error("cross product overflow");
+	return r;
+}
+
+// Andrew's monotone chain. Sorted by x then y, a cheaper comparison than the polar angle,
+// then the lower hull left to right and the upper hull back. Collinear points are dropped,
+// as in convex_hull. Counter clockwise from the leftmost point. The sort is most of the
+// work so first anything strictly inside the quadrilateral of the leftmost, lowest,
+// rightmost and highest points is thrown away, which is most of a uniform spread.
+//
+std::vector<pt_t> monotone_chain(std::span<const pt_t> in, auto cross)
+{
+	auto[l, r] = std::ranges::minmax(in);
+	auto[b, t] = std::ranges::minmax(in, {}, [](pt_t p){ return std::make_pair(p.second, p.first);});
+	std::array q{ l, b, r, t, l };
+	std::vector<pt_t> pp;
+	pp.reserve(in.size());
+	for(auto p : in)
+	{
+		bool out = false;
+		for(size_t n = 0; n < 4 && !out; ++n)
+			out = cross(q[n], q[n + 1], p) <= 0;
+		if(out)
+			pp.emplace_back(p);
+	}
+	std::ranges::sort(pp);
+	auto[ue, ul] = std::ranges::unique(pp);
+	pp.erase(ue, ul);
+	if(pp.size() < 3)
+		return pp;
+	std::vector<pt_t> h(2 * pp.size());
+	size_t k = 0;
+	for(auto p : pp)
+	{
+		while(k >= 2 && cross(h[k - 2], h[k - 1], p) <= 0)
+			--k;
+		h[k++] = p;
+	}
+	auto lo = k + 1;
+	for(auto p : pp | std::views::reverse | std::views::drop(1))
+	{
+		while(k >= lo && cross(h[k - 2], h[k - 1], p) <= 0)
+			--k;
+		h[k++] = p;
+	}
+	h.resize(k - 1);
+	return h;
+}
+
+std::vector<pt_t> monotone_hull(std::span<const pt_t> in)
+{
+	if(in.empty())
+		return {};
+	auto[xl, xh] = std::ranges::minmax(in | std::views::keys);
+	auto[yl, yh] = std::ranges::minmax(in | std::views::values);
+	constexpr __int128 lim = __int128(1) << 31;
+	if(__int128(xh) - xl < lim && __int128(yh) - yl < lim)
+		return monotone_chain(in, cross64);
+	return monotone_chain(in, cross128);
+}
+
+// an independent check of a hull for when Graham can't be run. It has to turn left at
+// every vertex, every vertex has to be an input point, and every input point has to be
+// inside or on it, found by binary search over the wedges from h[0]. Plain 128 bit
+// arithmetic, exact for coordinates within 2^62.
+//
+bool hull_ok(std::span<const pt_t> in, std::vector<pt_t> const& h)
+{
+	auto cr = [](pt_t o, pt_t a, pt_t b)
+		{
+			return (__int128(a.first) - o.first) * (__int128(b.second) - o.second) - (__int128(a.second) - o.second) * (__int128(b.first) - o.first);
+		};
+	auto n = h.size();
+	if(n < 3)
+		return false;
+	for(size_t v = 0; v < n; ++v)
+		if(cr(h[v], h[(v + 1) % n], h[(v + 2) % n]) <= 0)
+			return false;
+	std::vector<pt_t> srt(in.begin(), in.end());
+	std::ranges::sort(srt);
+	for(auto p : h)
+		if(!std::ranges::binary_search(srt, p))
+			return false;
+	for(auto p : in)
+	{
+		if(cr(h[0], h[1], p) < 0 || cr(h[0], h[n - 1], p) > 0)
+			return false;
+		// the last k with p left of h[0] h[k]
+		size_t lo = 1;
+		size_t hi = n - 1;
+		while(hi - lo > 1)
+		{
+			auto m = (lo + hi) / 2;
+			if(cr(h[0], h[m], p) >= 0)
+				lo = m;
+			else
+				hi = m;
+		}
+		if(cr(h[lo], h[lo + 1], p) < 0)
+			return false;
+	}
+	return true;
+}
+
+// -B, Graham against the monotone chain on a million random points, spread over a square
+// and then close to a circle, where nearly every point is on the hull. Then a circle
+// spanning more than 2^31, which takes the checked 128 bit cross product. Graham
+// overflows there so that hull is checked by hull_ok instead.
+//
+void bench_hull()
+{
+	std::mt19937_64 rng(9);
+	std::uniform_int_distribution<int64_t> sq(0, 1'000'000'000);
+	std::uniform_real_distribution<double> th(0, 2 * std::numbers::pi);
+	std::uniform_int_distribution<int64_t> dr(0, 1000);
+	std::vector<pt_t> square;
+	std::vector<pt_t> circle;
+	std::vector<pt_t> wide;
+	for(int n = 0; n < 1'000'000; ++n)
+	{
+		square.emplace_back(sq(rng), sq(rng));
+		auto t = th(rng);
+		auto r = 1'000'000'000.0 + dr(rng);
+		circle.emplace_back(int64_t(r * std::cos(t)), int64_t(r * std::sin(t)));
+		t = th(rng);
+		r = 4'000'000'000.0 + dr(rng);
+		wide.emplace_back(int64_t(r * std::cos(t)), int64_t(r * std::sin(t)));
+	}
+	// sorted hull and ms per run
+	auto time = [](auto&& f)
+		{
+			auto[h, ns] = repeat_for(200ms, f);
+			std::ranges::sort(h);
+			return std::make_pair(h, ns / 1'000'000.0);
+		};
+	for(auto[name, pp] : { std::pair{ "square", &square }, std::pair{ "circle", &circle } })
+	{
+		auto[hg, tg] = time([&](){ auto cp = *pp; return convex_hull(cp);});
+		auto[hm, tm] = time([&](){ return monotone_hull(*pp);});
+		fmt::println("{:>6} : graham {:.3f} ms, monotone {:.3f} ms, {} hull points{}", name, tg, tm, hm.size(), hg == hm ? "" : " MISMATCH");
+	}
+	// in hull order, hull_ok needs it
+	auto[hw, tw] = repeat_for(200ms, [&](){ return monotone_hull(wide);});
+	fmt::println("{:>6} : monotone {:.3f} ms, {} hull points{}", "wide", tw / 1'000'000.0, hw.size(), hull_ok(wide, hw) ? "" : " MISMATCH");
+}
+
+int64_t pt1(auto const& in)
 {
 	timer t("p1");
 	auto area = [](auto a, auto b){ return (std::abs(a.first - b.first) + 1) * (std::abs(a.second - b.second) + 1);};
 	int64_t p1 = 0;
-	auto pp = convex_hull(in);
-	for (auto y = 0; y < pp.size() - 1; ++y)
-		for (auto x = y + 1; x < pp.size(); ++x)
+	auto pp = monotone_hull(in);
+	for (auto y = 0; y < pp.size(); ++y)
+		for (auto x = y; x < pp.size(); ++x)
 			p1 = std::max(p1, area(pp[x], pp[y]));
 
 	return p1;
 }
 
+// the biggest rectangle has one corner with nothing below and to the left of it and the
+// other with nothing above and to the right, or the same on the other diagonal. Each set
+// of corners is a staircase, y falling as x rises. Moving along one staircase the best
+// partner on the other only ever moves the same way, so divide and conquer finds every
+// best partner in O(H log H). A pair that isn't the right way round comes out no bigger
+// than its real area, so it can't win by mistake.
+//
+std::vector<pt_t> lower_stair(std::vector<pt_t> pp)
+{
+	std::ranges::sort(pp);
+	std::vector<pt_t> r;
+	for(auto p : pp)
+		if(r.empty() || p.second < r.back().second)
+			r.emplace_back(p);
+	return r;
+}
+
+std::vector<pt_t> upper_stair(std::vector<pt_t> pp)
+{
+	std::ranges::sort(pp, std::greater());
+	std::vector<pt_t> r;
+	for(auto p : pp)
+		if(r.empty() || p.second > r.back().second)
+			r.emplace_back(p);
+	std::ranges::reverse(r);
+	return r;
+}
+
+// best partners in hi[ob, oe] for lo[b, e)
+void best_pair(std::vector<pt_t> const& lo, std::vector<pt_t> const& hi, size_t b, size_t e, size_t ob, size_t oe, int64_t& r)
+{
+	if(b >= e)
+		return;
+	auto m = (b + e) / 2;
+	auto om = ob;
+	int64_t mx = std::numeric_limits<int64_t>::min();
+	for(auto o = ob; o <= oe; ++o)
+	{
+		auto ar = (hi[o].first - lo[m].first + 1) * (hi[o].second - lo[m].second + 1);
+		if(ar > mx)
+		{
+			mx = ar;
+			om = o;
+		}
+	}
+	r = std::max(r, mx);
+	best_pair(lo, hi, b, m, ob, om, r);
+	best_pair(lo, hi, m + 1, e, om, oe, r);
+}
+
+int64_t stair_max(std::vector<pt_t> const& pp)
+{
+	auto lo = lower_stair(pp);
+	auto hi = upper_stair(pp);
+	int64_t r = 0;
+	best_pair(lo, hi, 0, lo.size(), 0, hi.size() - 1, r);
+	return r;
+}
+
+int64_t pt1_stairs(auto const& in)
+{
+	timer t("p1 stairs");
+	auto flip = in;
+	for(auto& p : flip)
+		p.second = -p.second;
+	return std::max(stair_max(in), stair_max(flip));
+}
+
 template<typename T> bool between(T t, T a, T b)
 {
 	return (t >= a && t <= b) || (t <= a && t >= b);
@@ -154,11 +398,9 @@ bool all_inside(auto a, auto b, auto const& vp, auto const& xx, auto const& yy)
 	return false;
 }
 
-int64_t pt2(auto const& in)
+// the distinct x and y coordinates, sorted
+auto compress(auto const& in)
 {
-	timer t("p2");
-	auto area = [](auto a, auto b){ return (std::abs(a.first - b.first) + 1) * (std::abs(a.second - b.second) + 1);};
-
 	std::vector<int64_t> xx;
 	std::vector<int64_t> yy;
 	for (auto p : in)
@@ -172,6 +414,15 @@ int64_t pt2(auto const& in)
 	xx.erase(xe, xl);
 	auto[ye, yl] = std::ranges::unique(yy);
 	yy.erase(ye, yl);
+	return std::make_pair(xx, yy);
+}
+
+int64_t pt2(auto const& in)
+{
+	timer t("p2");
+	auto area = [](auto a, auto b){ return (std::abs(a.first - b.first) + 1) * (std::abs(a.second - b.second) + 1);};
+
+	auto[xx, yy] = compress(in);
 	int64_t p2 = 0;
 	for(auto y = 0; y < in.size() - 1; ++y)
 		for(auto x = y + 1; x < in.size(); ++x)
@@ -183,11 +434,462 @@ int64_t pt2(auto const& in)
 	return p2;
 }
 
-int main()
+// the compressed grid. Each coordinate in xx becomes a column and the tiles between it
+// and the next, if there are any, the column after, with a column of padding either side,
+// so every cell is wholly in or out. The boundary is drawn, the outside flood filled in
+// from the padding and a 2D prefix sum of outside cells makes 'is this rectangle all
+// inside' four lookups.
+//
+class tile_grid
+{
+	std::vector<int64_t> xx_;
+	std::vector<int64_t> yy_;
+	std::vector<size_t> xc_;
+	std::vector<size_t> yc_;
+	size_t w_;
+	size_t h_;
+	std::vector<int32_t> sum_;
+
+	static std::vector<size_t> cells(std::vector<int64_t> const& v)
+	{
+		std::vector<size_t> r;
+		size_t c = 1;
+		for(size_t n = 0; n < v.size(); ++n)
+		{
+			r.emplace_back(c);
+			c += (n + 1 < v.size() && v[n + 1] - v[n] > 1) ? 2 : 1;
+		}
+		return r;
+	}
+	static size_t cell(std::vector<int64_t> const& v, std::vector<size_t> const& vc, int64_t c)
+	{
+		return vc[std::ranges::lower_bound(v, c) - v.begin()];
+	}
+	int32_t& at(size_t x, size_t y)
+	{
+		return sum_[y * (w_ + 1) + x];
+	}
+	int32_t at(size_t x, size_t y) const
+	{
+		return sum_[y * (w_ + 1) + x];
+	}
+
+public:
+	explicit tile_grid(std::vector<pt_t> const& in)
+	{
+		std::tie(xx_, yy_) = compress(in);
+		xc_ = cells(xx_);
+		yc_ = cells(yy_);
+		w_ = xc_.back() + 2;
+		h_ = yc_.back() + 2;
+		// 0 unknown, 1 boundary, 2 outside
+		std::vector<uint8_t> g(w_ * h_, 0);
+		for(auto i1 = in.begin(), i2 = i1 + 1; i2 != in.end(); ++i1, ++i2)
+		{
+			auto[xa, xb] = std::minmax({ cell(xx_, xc_, i1->first), cell(xx_, xc_, i2->first) });
+			auto[ya, yb] = std::minmax({ cell(yy_, yc_, i1->second), cell(yy_, yc_, i2->second) });
+			for(auto y = ya; y <= yb; ++y)
+				for(auto x = xa; x <= xb; ++x)
+					g[y * w_ + x] = 1;
+		}
+		std::vector<size_t> st{ 0 };
+		g[0] = 2;
+		while(!st.empty())
+		{
+			auto c = st.back();
+			st.pop_back();
+			auto x = c % w_;
+			auto y = c / w_;
+			auto visit = [&](size_t n)
+				{
+					if(g[n] == 0)
+					{
+						g[n] = 2;
+						st.emplace_back(n);
+					}
+				};
+			if(x > 0)
+				visit(c - 1);
+			if(x + 1 < w_)
+				visit(c + 1);
+			if(y > 0)
+				visit(c - w_);
+			if(y + 1 < h_)
+				visit(c + w_);
+		}
+		sum_.assign((w_ + 1) * (h_ + 1), 0);
+		for(size_t y = 0; y < h_; ++y)
+			for(size_t x = 0; x < w_; ++x)
+				at(x + 1, y + 1) = (g[y * w_ + x] == 2) + at(x, y + 1) + at(x + 1, y) - at(x, y);
+	}
+	bool all_inside(pt_t a, pt_t b) const
+	{
+		auto[xa, xb] = std::minmax({ cell(xx_, xc_, a.first), cell(xx_, xc_, b.first) });
+		auto[ya, yb] = std::minmax({ cell(yy_, yc_, a.second), cell(yy_, yc_, b.second) });
+		return at(xb + 1, yb + 1) - at(xa, yb + 1) - at(xb + 1, ya) + at(xa, ya) == 0;
+	}
+};
+
+// the biggest rectangle is_in accepts, the pairs in input order
+int64_t best_rect(auto const& in, auto&& is_in)
 {
+	auto area = [](auto a, auto b){ return (std::abs(a.first - b.first) + 1) * (std::abs(a.second - b.second) + 1);};
+	int64_t p2 = 0;
+	for(auto y = 0; y < in.size() - 1; ++y)
+		for(auto x = y + 1; x < in.size(); ++x)
+		{
+			auto ar = area(in[x], in[y]);
+			if(ar > p2 && is_in(in[x], in[y]))
+				p2 = ar;
+		}
+	return p2;
+}
+
+int64_t pt2_grid(auto const& in)
+{
+	timer t("p2 grid");
+	tile_grid tg(in);
+	return best_rect(in, [&](pt_t a, pt_t b){ return tg.all_inside(a, b);});
+}
+
+// the tiles inside the polygon as sorted, disjoint, closed spans along each row at a y
+// in yy and along each slab of rows between two, where the vertical edges crossing are
+// the same all the way through. Whether a point, or a run of tiles along a row, is inside
+// is then a binary search. Tiles on the boundary count as inside, as they do for inside().
+//
+class span_index
+{
+	using span_t = std::pair<int64_t, int64_t>;
+	std::vector<int64_t> yy_;
+	// row yy_[k] at 2k, the slab after it at 2k + 1
+	std::vector<std::vector<span_t>> sp_;
+
+	std::vector<span_t> spans(std::vector<pt_t> const& in, int64_t y) const
+	{
+		std::vector<int64_t> xs;
+		std::vector<span_t> s;
+		for(auto i1 = in.begin(), i2 = i1 + 1; i2 != in.end(); ++i1, ++i2)
+		{
+			auto[lo, hi] = std::minmax(i1->second, i2->second);
+			if(i1->first == i2->first)
+			{
+				// half open so a ray along a horizontal edge counts its ends once
+				if(lo <= y && y < hi)
+					xs.emplace_back(i1->first);
+				if(lo <= y && y <= hi)
+					s.emplace_back(i1->first, i1->first);
+			}
+			else if(i1->second == y)
+				s.emplace_back(std::minmax(i1->first, i2->first));
+		}
+		std::ranges::sort(xs);
+		for(size_t n = 0; n + 1 < xs.size(); n += 2)
+			s.emplace_back(xs[n], xs[n + 1]);
+		std::ranges::sort(s);
+		std::vector<span_t> r;
+		for(auto v : s)
+		{
+			if(!r.empty() && v.first <= r.back().second + 1)
+				r.back().second = std::max(r.back().second, v.second);
+			else
+				r.emplace_back(v);
+		}
+		return r;
+	}
+	std::vector<span_t> const* find(int64_t y) const
+	{
+		auto it = std::ranges::upper_bound(yy_, y);
+		if(it == yy_.begin())
+			return nullptr;
+		size_t k = it - yy_.begin() - 1;
+		if(yy_[k] == y)
+			return &sp_[2 * k];
+		if(k + 1 == yy_.size())
+			return nullptr;
+		return &sp_[2 * k + 1];
+	}
+
+public:
+	// in is the closed loop
+	explicit span_index(std::vector<pt_t> const& in)
+	{
+		yy_ = compress(in).second;
+		sp_.resize(2 * yy_.size());
+		for(size_t k = 0; k < yy_.size(); ++k)
+		{
+			sp_[2 * k] = spans(in, yy_[k]);
+			if(k + 1 < yy_.size() && yy_[k + 1] - yy_[k] > 1)
+				sp_[2 * k + 1] = spans(in, yy_[k] + 1);
+		}
+	}
+	// x1 <= x2
+	bool run_inside(int64_t y, int64_t x1, int64_t x2) const
+	{
+		auto s = find(y);
+		if(s == nullptr)
+			return false;
+		auto it = std::ranges::upper_bound(*s, x1, {}, &span_t::first);
+		if(it == s->begin())
+			return false;
+		return std::prev(it)->second >= x2;
+	}
+};
+
+// rows and, built again on its side, columns. A rectangle is inside if its sides are,
+// the polygon has no holes.
+//
+class edge_index
+{
+	span_index rows_;
+	span_index cols_;
+
+	static std::vector<pt_t> transpose(std::vector<pt_t> in)
+	{
+		for(auto& p : in)
+			std::swap(p.first, p.second);
+		return in;
+	}
+
+public:
+	explicit edge_index(std::vector<pt_t> const& in) : rows_(in), cols_(transpose(in))
+	{
+	}
+	bool inside(pt_t p) const
+	{
+		return rows_.run_inside(p.second, p.first, p.first);
+	}
+	bool all_inside(pt_t a, pt_t b) const
+	{
+		auto[xa, xb] = std::minmax(a.first, b.first);
+		auto[ya, yb] = std::minmax(a.second, b.second);
+		return rows_.run_inside(ya, xa, xb) && rows_.run_inside(yb, xa, xb) &&
+			cols_.run_inside(xa, ya, yb) && cols_.run_inside(xb, ya, yb);
+	}
+};
+
+int64_t pt2_index(auto const& in)
+{
+	timer t("p2 index");
+	edge_index ei(in);
+	return best_rect(in, [&](pt_t a, pt_t b){ return ei.all_inside(a, b);});
+}
+
+// inside() and edge_index should agree on every point of the compressed grid, and
+// the points either side of each coordinate
+int64_t check_index(auto const& in)
+{
+	edge_index ei(in);
+	auto[xx, yy] = compress(in);
+	auto near = [](std::vector<int64_t> const& v)
+		{
+			std::vector<int64_t> r;
+			for(auto c : v)
+				r.insert(r.end(), { c - 1, c, c + 1 });
+			return r;
+		};
+	int64_t bad = 0;
+	for(auto y : near(yy))
+		for(auto x : near(xx))
+			bad += inside(std::make_pair(x, y), in) != ei.inside({ x, y });
+	return bad;
+}
+
+// every pair as a candidate, sorted biggest first and handed out in that order to a
+// thread per core. The best found so far is shared, and as nothing after it can be any
+// bigger a thread stops as soon as its next candidate can't beat it, or once it has
+// found one of its own. is_in is the rectangle test.
+//
+int64_t pt2_par(auto const& in, auto&& is_in)
+{
+	timer t("p2 par");
+	struct cand_t
+	{
+		int64_t ar_;
+		uint32_t a_;
+		uint32_t b_;
+	};
+	std::vector<cand_t> cc;
+	cc.reserve(in.size() * (in.size() - 1) / 2);
+	for(uint32_t y = 0; y < in.size() - 1; ++y)
+		for(uint32_t x = y + 1; x < in.size(); ++x)
+			cc.emplace_back((std::abs(in[x].first - in[y].first) + 1) * (std::abs(in[x].second - in[y].second) + 1), x, y);
+	std::ranges::sort(cc, std::greater(), &cand_t::ar_);
+
+	std::atomic<size_t> next = 0;
+	std::atomic<int64_t> best = 0;
+	auto work = [&]()
+		{
+			for(auto n = next++; n < cc.size(); n = next++)
+			{
+				auto const& c = cc[n];
+				if(c.ar_ <= best.load(std::memory_order_relaxed))
+					return;
+				if(is_in(in[c.a_], in[c.b_]))
+				{
+					auto b = best.load();
+					while(b < c.ar_ && !best.compare_exchange_weak(b, c.ar_))
+						;
+					return;
+				}
+			}
+		};
+	size_t nt = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::future<void>> fs;
+	for(size_t n = 0; n < nt; ++n)
+		fs.emplace_back(std::async(std::launch::async, work));
+	for(auto& f : fs)
+		f.get();
+	return best;
+}
+
+// candidate pruning, before any rectangle is tested. A red tile can only be the corner of
+// a rectangle inside the polygon if the inside at that tile covers the rectangle's
+// quadrant, one quadrant at a convex corner, three at a reflex one. What's left is cut
+// by area against the best found so far. Rectangles one tile wide or high aren't pruned
+// by quadrant, just tested.
+//
+int64_t pt2_pruned(auto const& in, auto&& is_in)
+{
+	timer t("p2 pruned");
+	auto area = [](auto a, auto b){ return (std::abs(a.first - b.first) + 1) * (std::abs(a.second - b.second) + 1);};
+	auto sgn = [](int64_t v){ return int64_t(v > 0) - int64_t(v < 0);};
+	auto quad = [](int64_t dx, int64_t dy){ return (dx > 0) | (dy > 0) << 1;};
+	// in is the closed loop, one vertex short of its size
+	auto n = in.size() - 1;
+	int64_t s = 0;
+	for(size_t v = 0; v < n; ++v)
+		s += in[v].first * in[v + 1].second - in[v + 1].first * in[v].second;
+	std::vector<std::array<bool, 4>> open(n);
+	for(size_t v = 0; v < n; ++v)
+	{
+		auto pr = in[(v + n - 1) % n];
+		auto nx = in[v + 1];
+		auto ux = sgn(in[v].first - pr.first);
+		auto uy = sgn(in[v].second - pr.second);
+		auto vx = sgn(nx.first - in[v].first);
+		auto vy = sgn(nx.second - in[v].second);
+		auto cr = ux * vy - uy * vx;
+		auto q = quad(vx - ux, vy - uy);
+		for(int k = 0; k < 4; ++k)
+			open[v][k] = cr == 0 || (cr * s > 0 ? k == q : k != q);
+	}
+	std::vector<size_t> ox(n);
+	std::iota(ox.begin(), ox.end(), 0);
+	std::ranges::sort(ox, {}, [&](size_t v){ return in[v].first;});
+
+	int64_t p2 = 0;
+	int64_t tested = 0;
+	for(size_t a = 0; a < n; ++a)
+	{
+		auto pa = in[a];
+		for(auto b : ox | std::views::reverse)
+		{
+			auto pb = in[b];
+			if(pb.first < pa.first)
+				break;
+			auto ar = area(pa, pb);
+			if(ar <= p2 || b == a)
+				continue;
+			if(pb.first == pa.first || pb.second == pa.second)
+			{
+				if(b < a)
+					continue;
+			}
+			else
+			{
+				auto dy = sgn(pb.second - pa.second);
+				if(!open[a][quad(1, dy)] || !open[b][quad(-1, -dy)])
+					continue;
+			}
+			++tested;
+			if(is_in(pa, pb))
+				p2 = ar;
+		}
+	}
+	fmt::println("{} of {} pairs tested, {:.2f}%", tested, n * (n - 1) / 2, 100.0 * tested / (n * (n - 1) / 2));
+	return p2;
+}
+
+// run f, a pt2 engine, with the rectangle test -g or -i asked for, or the original
+int64_t with_test(auto const& in, bool grid, bool index, auto&& f)
+{
+	if(grid)
+	{
+		tile_grid tg(in);
+		return f([&](pt_t a, pt_t b){ return tg.all_inside(a, b);});
+	}
+	if(index)
+	{
+		edge_index ei(in);
+		return f([&](pt_t a, pt_t b){ return ei.all_inside(a, b);});
+	}
+	auto[xx, yy] = compress(in);
+	return f([&](pt_t a, pt_t b){ return all_inside(a, b, in, xx, yy);});
+}
+
+// pt1 from the staircases. The hull pairs drop red tiles lying on a hull edge so they
+// are only run by -v
+// -B benchmark the hulls
+// -g pt2 from the compressed grid
+// -i pt2 from the edge index
+// -t pt2 from candidates sorted by area, on every core
+// -d pt2 from the pruned candidates. -t and -d use the -g or -i test if asked
+// -v check the staircase pt1 against the hull pairs, the grid pt2 and the edge index
+// against the originals
+//
+int main(int ac, char* av[])
+{
+	bool grid = false;
+	bool index = false;
+	bool par = false;
+	bool prune = false;
+	bool verify = false;
+	bool bench = false;
+	for(int n = 1; n < ac; ++n)
+	{
+		std::string_view a(av[n]);
+		if(a == "-g")
+			grid = true;
+		else if(a == "-i")
+			index = true;
+		else if(a == "-t")
+			par = true;
+		else if(a == "-d")
+			prune = true;
+		else if(a == "-v")
+			verify = true;
+		else if(a == "-B")
+			bench = true;
+	}
+	if(bench)
+	{
+		bench_hull();
+		return 0;
+	}
 	auto in = get_input();
-	auto p1 = pt1(in);
-	auto p2 = pt2(in);
+	if(verify)
+	{
+		auto p1 = pt1_stairs(in);
+		auto ph = pt1(in);
+		auto pg = pt2_grid(in);
+		auto p2 = pt2(in);
+		fmt::println("pt1 = {}, hull {}{}", p1, ph, p1 == ph ? "" : " MISMATCH");
+		fmt::println("pt2 = {}, grid {}{}", p2, pg, p2 == pg ? "" : " MISMATCH");
+		fmt::println("edge index disagrees with inside() on {} points", check_index(in));
+		return 0;
+	}
+	auto p1 = pt1_stairs(in);
+	int64_t p2 = 0;
+	if(par)
+		p2 = with_test(in, grid, index, [&](auto&& is_in){ return pt2_par(in, is_in);});
+	else if(prune)
+		p2 = with_test(in, grid, index, [&](auto&& is_in){ return pt2_pruned(in, is_in);});
+	else if(grid)
+		p2 = pt2_grid(in);
+	else if(index)
+		p2 = pt2_index(in);
+	else
+		p2 = pt2(in);
 	fmt::println("pt1 = {}", p1);
 	fmt::println("pt2 = {}", p2);
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <numeric>
+#include <utility>
+#include <cstdint>
+
+// disjoint set forest with union by size and path compression. Keeps the size of each
+// component, at its root, and the number of components.
+//
+class disjoint_set
+{
+	std::vector<int64_t> parent_;
+	std::vector<int64_t> size_;
+	int64_t count_;
+
+public:
+	explicit disjoint_set(size_t n) : parent_(n), size_(n, 1), count_(n)
+	{
+		std::iota(parent_.begin(), parent_.end(), 0);
+	}
+	int64_t find(int64_t a)
+	{
+		auto r = a;
+		while(parent_[r] != r)
+			r = parent_[r];
+		while(parent_[a] != r)
+			a = std::exchange(parent_[a], r);
+		return r;
+	}
+	// false if a and b were already connected
+	bool unite(int64_t a, int64_t b)
+	{
+		a = find(a);
+		b = find(b);
+		if(a == b)
+			return false;
+		if(size_[a] < size_[b])
+			std::swap(a, b);
+		parent_[b] = a;
+		size_[a] += size_[b];
+		--count_;
+		return true;
+	}
+	int64_t size(int64_t a)
+	{
+		return size_[find(a)];
+	}
+	int64_t count() const
+	{
+		return count_;
+	}
+	// the size of every component
+	std::vector<int64_t> sizes() const
+	{
+		std::vector<int64_t> r;
+		r.reserve(count_);
+		for(int64_t n = 0; n < parent_.size(); ++n)
+			if(parent_[n] == n)
+				r.emplace_back(size_[n]);
+		return r;
+	}
+};
@@ -2,6 +2,8 @@
 
 #include <string_view>
 #include <chrono>
+#include <utility>
+#include <cstdint>
 
 using namespace std::literals;
 
@@ -37,4 +39,22 @@ public:
 	{
 		cancel_ = true;
 	}
-};
\ No newline at end of file
+};
+
+// runs f over and over for at least mn, to steady timings too short to read from one
+// run. Returns f's last result and the mean ns per run.
+//
+template<typename F> auto repeat_for(std::chrono::nanoseconds mn, F&& f)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	auto r = f();
+	int64_t reps = 1;
+	auto el = std::chrono::high_resolution_clock::now() - start;
+	while(el < mn)
+	{
+		r = f();
+		++reps;
+		el = std::chrono::high_resolution_clock::now() - start;
+	}
+	return std::make_pair(std::move(r), double(std::chrono::duration_cast<std::chrono::nanoseconds>(el).count()) / reps);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+// fixed width unsigned integer of N 64 bit limbs, least significant first. Only
+// addition and decimal conversion, enough for a counter. Wraps like any unsigned.
+//
+template<size_t N> struct wide_uint
+{
+	std::array<uint64_t, N> l_{};
+
+	wide_uint() = default;
+	wide_uint(uint64_t v)
+	{
+		l_[0] = v;
+	}
+	wide_uint& operator+=(wide_uint const& o)
+	{
+		uint64_t c = 0;
+		for(size_t n = 0; n < N; ++n)
+		{
+			auto s = l_[n] + c;
+			c = s < c;
+			l_[n] = s + o.l_[n];
+			c += l_[n] < s;
+		}
+		return *this;
+	}
+	friend wide_uint operator+(wide_uint a, wide_uint const& b)
+	{
+		return a += b;
+	}
+	bool operator==(wide_uint const&) const = default;
+	explicit operator bool() const
+	{
+		return std::ranges::any_of(l_, [](auto v){ return v != 0;});
+	}
+	// peels off 19 decimal digits at a time
+	std::string to_string() const
+	{
+		constexpr uint64_t e19 = 10'000'000'000'000'000'000ULL;
+		auto w = *this;
+		std::string r;
+		while(w)
+		{
+			unsigned __int128 rem = 0;
+			for(size_t n = N; n-- > 0; )
+			{
+				auto cur = (rem << 64) | w.l_[n];
+				w.l_[n] = uint64_t(cur / e19);
+				rem = cur % e19;
+			}
+			auto d = std::to_string(uint64_t(rem));
+			if(w)
+				d.insert(0, 19 - d.size(), '0');
+			r.insert(0, d);
+		}
+		return r.empty() ? "0" : r;
+	}
+};